@@ -122,6 +122,7 @@ public:
 
   bool remove(const Key& key);
   T *take(const Key& key);
+  template <class Predicate> size_t removeIf(Predicate pred);
 
 private:
   void trim(size_t m);
@@ -152,6 +153,24 @@ inline T *Cache<Key, T>::take(const Key& key)
   return t;
 }
 
+// Removes all objects for which pred(object) is true, returns how many were removed
+template <class Key, class T>
+template <class Predicate>
+size_t Cache<Key, T>::removeIf(Predicate pred)
+{
+  size_t removed = 0;
+  Node *n = f;
+  while (n) {
+    Node *u = n;
+    n = n->n;
+    if (pred(*u->t)) {
+      unlink(*u);
+      removed++;
+    }
+  }
+  return removed;
+}
+
 template <class Key, class T>
 bool Cache<Key, T>::insert(const Key& akey, T *aobject, size_t acost)
 {
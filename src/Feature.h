@@ -17,9 +17,12 @@ public:
   static const Feature ExperimentalInputDriverDBus;
   static const Feature ExperimentalLazyUnion;
   static const Feature ExperimentalVxORenderersIndexing;
+  static const Feature ExperimentalVxORenderersInstancing;
   static const Feature ExperimentalTextMetricsFunctions;
   static const Feature ExperimentalImportFunction;
   static const Feature ExperimentalPredictibleOutput;
+  static const Feature ExperimentalSurfaceDecimation;
+  static const Feature ExperimentalMinkowskiOffset;
 #ifdef ENABLE_PYTHON
   static const Feature ExperimentalPythonEngine;
 #endif
@@ -27,7 +27,11 @@
 #include "FontCache.h"
 
 #include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <system_error>
 #include <vector>
 
 #include <filesystem>
@@ -35,6 +39,12 @@
 #include <string>
 #include <utility>
 
+#if defined __WIN32__ || defined _MSC_VER
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 #include "platform/PlatformUtils.h"
 #include "utils/printutils.h"
 #include "utils/version_helper.h"
@@ -105,6 +115,108 @@ const uint32_t FontInfo::get_hash() const
   return hash;
 }
 
+namespace {
+
+const std::string FONT_INDEX_HEADER("OpenSCAD font index 1");
+
+int process_id()
+{
+#if defined __WIN32__ || defined _MSC_VER
+  return _getpid();
+#else
+  return getpid();
+#endif
+}
+
+int64_t mtime(const std::string& path)
+{
+  std::error_code ec;
+  auto time = fs::last_write_time(fs::path(path), ec);
+  return ec ? -1 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+} // namespace
+
+void FontIndex::load()
+{
+  if (path.empty()) return;
+  std::ifstream in(path);
+  std::string line;
+  if (!std::getline(in, line) || line != FONT_INDEX_HEADER) return;
+  if (!std::getline(in, line) || line != fingerprint) return;
+
+  // Dependencies are written first; any change invalidates the whole index.
+  decltype(entries) loaded;
+  while (std::getline(in, line)) {
+    std::vector<std::string> fields;
+    boost::split(fields, line, boost::is_any_of("\t"));
+    if (fields.size() == 3 && (fields[0] == "c" || fields[0] == "d")) {
+      if (std::to_string(mtime(fields[2])) != fields[1]) {
+        PRINTDB("Font index outdated: %s", fields[2]);
+        return;
+      }
+    } else if (fields.size() == 4 && fields[0] == "f") {
+      loaded[fields[3]] = {fields[2], std::atoi(fields[1].c_str())};
+    } else {
+      return;
+    }
+  }
+  entries = std::move(loaded);
+}
+
+void FontIndex::save(FcConfig *config)
+{
+  if (path.empty() || !dirty) return;
+  dirty = false;
+  // Other OpenSCAD processes may be saving the index at the same time, so each
+  // writes its own file and renames it into place
+  const std::string tmppath = path + "." + std::to_string(process_id()) + ".tmp";
+  {
+    std::ofstream out(tmppath, std::ios::trunc);
+    if (!out) return;
+    out << FONT_INDEX_HEADER << "\n" << fingerprint << "\n";
+    FcStrList *files = FcConfigGetConfigFiles(config);
+    while (FcChar8 *file = FcStrListNext(files)) {
+      out << "c\t" << mtime((const char *)file) << "\t" << (const char *)file << "\n";
+    }
+    FcStrListDone(files);
+    FcStrList *dirs = FcConfigGetFontDirs(config);
+    while (FcChar8 *dir = FcStrListNext(dirs)) {
+      out << "d\t" << mtime((const char *)dir) << "\t" << (const char *)dir << "\n";
+    }
+    FcStrListDone(dirs);
+    for (const auto& entry : entries) {
+      out << "f\t" << entry.second.second << "\t" << entry.second.first << "\t" << entry.first << "\n";
+    }
+    if (!out) {
+      out.close();
+      std::error_code ec;
+      fs::remove(tmppath, ec);
+      return;
+    }
+  }
+  std::error_code ec;
+  fs::rename(tmppath, path, ec);
+  if (ec) fs::remove(tmppath, ec);
+}
+
+const std::pair<std::string, int> *FontIndex::find(const std::string& lookup) const
+{
+  auto it = entries.find(lookup);
+  return it == entries.end() ? nullptr : &it->second;
+}
+
+void FontIndex::insert(const std::string& lookup, const std::string& file, int index)
+{
+  // Tabs and newlines would break the line based file format
+  if (lookup.find_first_of("\t\n") != std::string::npos ||
+      file.find_first_of("\t\n") != std::string::npos) return;
+  auto& entry = entries[lookup];
+  if (entry.first == file && entry.second == index) return;
+  entry = {file, index};
+  dirty = true;
+}
+
 FontCache *FontCache::self = nullptr;
 FontCache::InitHandlerFunc *FontCache::cb_handler = FontCache::defaultInitHandler;
 void *FontCache::cb_userdata = nullptr;
@@ -148,7 +260,7 @@ FontCache::FontCache()
     builtinfontpath = fs::canonical(builtinfontpath);
 #endif
     FcConfigParseAndLoad(this->config, reinterpret_cast<const FcChar8 *>(builtinfontpath.generic_string().c_str()), false);
-    add_font_dir(builtinfontpath.generic_string());
+    this->font_dirs.push_back(builtinfontpath.generic_string());
   }
 
   const char *home = getenv("HOME");
@@ -156,7 +268,7 @@ FontCache::FontCache()
   // Add Linux font folders, the system folders are expected to be
   // configured by the system configuration for fontconfig.
   if (home) {
-    add_font_dir(std::string(home) + "/.fonts");
+    this->font_dirs.push_back(std::string(home) + "/.fonts");
   }
 
   const char *env_font_path = getenv("OPENSCAD_FONT_PATH");
@@ -168,11 +280,46 @@ FontCache::FontCache()
       const fs::path p(boost::copy_range<std::string>(*it));
       if (fs::exists(p) && fs::is_directory(p)) {
         std::string path = fs::absolute(p).string();
-        add_font_dir(path);
+        this->font_dirs.push_back(path);
       }
     }
   }
 
+  // Registering the font directories and building the fonts is slow on systems
+  // with many fonts, so it's deferred to init_fonts(). Fonts we've resolved
+  // before are found through the index instead.
+  const std::string configpath = PlatformUtils::userConfigPath();
+  const char *env_fc_path = getenv("FONTCONFIG_PATH");
+  const char *env_fc_file = getenv("FONTCONFIG_FILE");
+  std::string fingerprint = std::string("FONTCONFIG_PATH=") + (env_fc_path ? env_fc_path : "") +
+                            "\tFONTCONFIG_FILE=" + (env_fc_file ? env_fc_file : "");
+  for (const auto& dir : this->font_dirs) fingerprint += "\t" + dir;
+  this->index = std::make_unique<FontIndex>(configpath.empty() ? "" : (fs::path(configpath) / "fontindex.cache").generic_string(), fingerprint);
+  this->index->load();
+
+  const FT_Error error = FT_Init_FreeType(&this->library);
+  if (error) {
+    LOG(message_group::Font_Warning, "Can't initialize freetype library, text() objects will not be rendered");
+    return;
+  }
+
+  this->init_ok = true;
+}
+
+void FontCache::init_fonts()
+{
+  if (this->fonts_init || !this->config) return;
+  this->fonts_init = true;
+
+  for (const auto& dir : this->font_dirs) {
+    add_font_dir(dir);
+  }
+  for (const auto& file : this->font_files) {
+    if (!FcConfigAppFontAddFile(this->config, reinterpret_cast<const FcChar8 *>(file.c_str()))) {
+      LOG("Can't register font '%1$s'", file);
+    }
+  }
+
   FontCacheInitializer initializer(this->config);
   cb_handler(&initializer, cb_userdata);
 
@@ -182,20 +329,22 @@ FontCache::FontCache()
     fontpath.emplace_back((const char *)dir);
   }
   FcStrListDone(dirs);
+}
 
-  const FT_Error error = FT_Init_FreeType(&this->library);
-  if (error) {
-    LOG(message_group::Font_Warning, "Can't initialize freetype library, text() objects will not be rendered");
-    return;
-  }
-
-  this->init_ok = true;
+const std::vector<std::string>& get_font_path()
+{
+  FontCache::instance()->init_fonts();
+  return fontpath;
 }
 
 FontCache *FontCache::instance()
 {
   if (!self) {
     self = new FontCache();
+    // Newly resolved fonts are written to the index once, when the process exits
+    std::atexit([]() {
+      if (self->index) self->index->save(self->config);
+    });
   }
   return self;
 }
@@ -222,6 +371,9 @@ void FontCache::registerProgressHandler(InitHandlerFunc *handler, void *userdata
 
 void FontCache::register_font_file(const std::string& path)
 {
+  // Files registered before the fonts are built are added by init_fonts()
+  this->font_files.push_back(path);
+  if (!this->fonts_init) return;
   if (!FcConfigAppFontAddFile(this->config, reinterpret_cast<const FcChar8 *>(path.c_str()))) {
     LOG("Can't register font '%1$s'", path);
   }
@@ -237,8 +389,9 @@ void FontCache::add_font_dir(const std::string& path)
   }
 }
 
-std::vector<uint32_t> FontCache::filter(const std::u32string& str) const
+std::vector<uint32_t> FontCache::filter(const std::u32string& str)
 {
+  init_fonts();
   FcObjectSet *object_set = FcObjectSetBuild(FC_FAMILY, FC_STYLE, FC_FILE, nullptr);
   FcPattern *pattern = FcPatternCreate();
   init_pattern(pattern);
@@ -265,8 +418,9 @@ std::vector<uint32_t> FontCache::filter(const std::u32string& str) const
   return result;
 }
 
-FontInfoList *FontCache::list_fonts() const
+FontInfoList *FontCache::list_fonts()
 {
+  init_fonts();
   FcObjectSet *object_set = FcObjectSetBuild(FC_FAMILY, FC_STYLE, FC_FILE, nullptr);
   FcPattern *pattern = FcPatternCreate();
   init_pattern(pattern);
@@ -305,52 +459,50 @@ bool FontCache::is_init_ok() const
 
 void FontCache::clear()
 {
+  for (const auto& entry : this->cache) {
+    FT_Done_Face(entry.second);
+  }
   this->cache.clear();
+  this->cache_map.clear();
 }
 
 void FontCache::dump_cache(const std::string& info)
 {
   std::cout << info << ":";
   for (const auto& item : this->cache) {
-    std::cout << " " << item.first << " (" << item.second.second << ")";
+    std::cout << " " << item.first;
   }
   std::cout << std::endl;
 }
 
 void FontCache::check_cleanup()
 {
-  if (this->cache.size() < MAX_NR_OF_CACHE_ENTRIES) {
-    return;
-  }
-
-  auto pos = this->cache.begin()++;
-  for (auto it = this->cache.begin(); it != this->cache.end(); ++it) {
-    if ((*pos).second.second > (*it).second.second) {
-      pos = it;
-    }
+  while (this->cache.size() >= MAX_NR_OF_CACHE_ENTRIES) {
+    FT_Done_Face(this->cache.back().second);
+    this->cache_map.erase(this->cache.back().first);
+    this->cache.pop_back();
   }
-  FT_Done_Face((*pos).second.first);
-  this->cache.erase(pos);
 }
 
 FT_Face FontCache::get_font(const std::string& font)
 {
-  FT_Face face;
-  auto it = this->cache.find(font);
-  if (it == this->cache.end()) {
-    face = find_face(font);
-    if (!face) {
-      return nullptr;
-    }
-    check_cleanup();
-  } else {
-    face = (*it).second.first;
+  auto it = this->cache_map.find(font);
+  if (it != this->cache_map.end()) {
+    this->cache.splice(this->cache.begin(), this->cache, it->second);
+    return it->second->second;
   }
-  this->cache[font] = cache_entry_t(face, time(nullptr));
+
+  FT_Face face = find_face(font);
+  if (!face) {
+    return nullptr;
+  }
+  check_cleanup();
+  this->cache.emplace_front(font, face);
+  this->cache_map[font] = this->cache.begin();
   return face;
 }
 
-FT_Face FontCache::find_face(const std::string& font) const
+FT_Face FontCache::find_face(const std::string& font)
 {
   std::string trimmed(font);
   boost::algorithm::trim(trimmed);
@@ -378,8 +530,20 @@ void FontCache::init_pattern(FcPattern *pattern) const
   FcPatternAdd(pattern, FC_SCALABLE, true_value, true);
 }
 
-FT_Face FontCache::find_face_fontconfig(const std::string& font) const
+FT_Face FontCache::find_face_fontconfig(const std::string& font)
 {
+  // Fonts registered by use<> may shadow previously resolved fonts
+  const bool use_index = this->font_files.empty();
+  if (use_index) {
+    if (const auto *entry = this->index->find(font)) {
+      if (FT_Face face = open_face(entry->first, entry->second)) {
+        return face;
+      }
+    }
+  }
+
+  init_fonts();
+
   FcResult result;
 
   FcPattern *pattern = FcNameParse((unsigned char *)font.c_str());
@@ -393,23 +557,38 @@ FT_Face FontCache::find_face_fontconfig(const std::string& font) const
   FcDefaultSubstitute(pattern);
 
   FcPattern *match = FcFontMatch(this->config, pattern, &result);
-
-  FcValue file_value;
-  if (FcPatternGet(match, FC_FILE, 0, &file_value) != FcResultMatch) {
+  FcPatternDestroy(pattern);
+  if (!match) {
     return nullptr;
   }
 
+  FcValue file_value;
   FcValue font_index;
-  if (FcPatternGet(match, FC_INDEX, 0, &font_index)) {
+  if (FcPatternGet(match, FC_FILE, 0, &file_value) != FcResultMatch ||
+      FcPatternGet(match, FC_INDEX, 0, &font_index) != FcResultMatch) {
+    FcPatternDestroy(match);
     return nullptr;
   }
 
-  FT_Face face;
-  FT_Error error = FT_New_Face(this->library, (const char *) file_value.u.s, font_index.u.i, &face);
-
-  FcPatternDestroy(pattern);
+  const std::string file((const char *) file_value.u.s);
+  const int index = font_index.u.i;
   FcPatternDestroy(match);
 
+  FT_Face face = open_face(file, index);
+  if (face && use_index) {
+    this->index->insert(font, file, index);
+  }
+  return face;
+}
+
+FT_Face FontCache::open_face(const std::string& file, int index) const
+{
+  FT_Face face;
+  FT_Error error = FT_New_Face(this->library, file.c_str(), index, &face);
+  if (error) {
+    return nullptr;
+  }
+
   for (int a = 0; a < face->num_charmaps; ++a) {
     FT_CharMap charmap = face->charmaps[a];
     PRINTDB("charmap = %d: platform = %d, encoding = %d", a % charmap->platform_id % charmap->encoding_id);
@@ -429,7 +608,7 @@ FT_Face FontCache::find_face_fontconfig(const std::string& font) const
     if (!charmap_set) LOG(message_group::Font_Warning, "Could not select a char map for font '%1$s/%2$s'", face->family_name, face->style_name);
   }
 
-  return error ? nullptr : face;
+  return face;
 }
 
 bool FontCache::try_charmap(FT_Face face, int platform_id, int encoding_id) const
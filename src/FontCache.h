@@ -27,10 +27,12 @@
 
 #include <utility>
 #include <cstdint>
-#include <map>
+#include <list>
 #include <string>
+#include <unordered_map>
 
 #include <ctime>
+#include <memory>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -77,11 +79,34 @@ private:
   FcConfig *config;
 };
 
+/**
+ * Persisted mapping of font lookup strings to the font file and face index
+ * fontconfig resolved them to. It's validated against the modification times
+ * of the fontconfig configuration files and font directories, so a cold
+ * start can open a face without building the fontconfig font set.
+ */
+class FontIndex
+{
+public:
+  FontIndex(std::string path, std::string fingerprint) : path(std::move(path)), fingerprint(std::move(fingerprint)) { }
+
+  void load();
+  // Writes the index if fonts were added since it was loaded or saved
+  void save(FcConfig *config);
+  [[nodiscard]] const std::pair<std::string, int> *find(const std::string& lookup) const;
+  void insert(const std::string& lookup, const std::string& file, int index);
+private:
+  std::string path;
+  std::string fingerprint;
+  std::unordered_map<std::string, std::pair<std::string, int>> entries;
+  bool dirty{false};
+};
+
 class FontCache
 {
 public:
   const static std::string DEFAULT_FONT;
-  const static unsigned int MAX_NR_OF_CACHE_ENTRIES = 3;
+  const static unsigned int MAX_NR_OF_CACHE_ENTRIES = 8;
 
   FontCache();
   virtual ~FontCache() = default;
@@ -91,9 +116,12 @@ public:
   [[nodiscard]] bool is_windows_symbol_font(const FT_Face& face) const;
   void register_font_file(const std::string& path);
   void clear();
-  [[nodiscard]] FontInfoList *list_fonts() const;
-  [[nodiscard]] std::vector<uint32_t> filter(const std::u32string&) const;
+  [[nodiscard]] FontInfoList *list_fonts();
+  [[nodiscard]] std::vector<uint32_t> filter(const std::u32string&);
   [[nodiscard]] const std::string get_freetype_version() const;
+  // Registers the application font directories and builds the fontconfig
+  // font set. This is deferred until a font can't be found in the font index.
+  void init_fonts();
 
   static FontCache *instance();
 
@@ -101,8 +129,9 @@ public:
   static void registerProgressHandler(InitHandlerFunc *handler, void *userdata = nullptr);
 
 private:
-  using cache_entry_t = std::pair<FT_Face, std::time_t>;
-  using cache_t = std::map<std::string, cache_entry_t>;
+  // Open faces, most recently used first.
+  using cache_entry_t = std::pair<std::string, FT_Face>;
+  using cache_t = std::list<cache_entry_t>;
 
   static FontCache *self;
   static InitHandlerFunc *cb_handler;
@@ -111,9 +140,14 @@ private:
   static void defaultInitHandler(FontCacheInitializer *delegate, void *userdata);
 
   bool init_ok;
+  bool fonts_init{false};
   cache_t cache;
+  std::unordered_map<std::string, cache_t::iterator> cache_map;
   FcConfig *config;
   FT_Library library;
+  std::vector<std::string> font_dirs;
+  std::vector<std::string> font_files;
+  std::unique_ptr<FontIndex> index;
 
   void check_cleanup();
   void dump_cache(const std::string& info);
@@ -121,8 +155,8 @@ private:
   void add_font_dir(const std::string& path);
   void init_pattern(FcPattern *pattern) const;
 
-  [[nodiscard]] FT_Face find_face(const std::string& font) const;
-  [[nodiscard]] FT_Face find_face_fontconfig(const std::string& font) const;
+  [[nodiscard]] FT_Face find_face(const std::string& font);
+  [[nodiscard]] FT_Face find_face_fontconfig(const std::string& font);
+  [[nodiscard]] FT_Face open_face(const std::string& file, int index) const;
   bool try_charmap(FT_Face face, int platform_id, int encoding_id) const;
 };
-
@@ -56,7 +56,7 @@
 #endif
 
 extern std::vector<std::string> librarypath;
-extern std::vector<std::string> fontpath;
+extern const std::vector<std::string>& get_font_path();
 extern const std::string get_cairo_version();
 extern const std::string get_lib3mf_version();
 extern const std::string get_fontconfig_version();
@@ -175,7 +175,7 @@ std::string LibraryInfo::info()
   s << "\nOPENSCAD_FONT_PATH: " << (env_font_path == nullptr ? "<not set>" : env_font_path)
     << "\nOpenSCAD font path:\n";
 
-  for (const auto& path : fontpath) {
+  for (const auto& path : get_font_path()) {
     s << "  " << path << "\n";
   }
 
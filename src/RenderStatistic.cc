@@ -39,6 +39,9 @@
 
 #include "utils/printutils.h"
 #include "geometry/GeometryCache.h"
+#include "geometry/ConversionCache.h"
+#include "geometry/Operation2DCache.h"
+#include "core/SourceFileCache.h"
 #include "geometry/PolySet.h"
 #include "geometry/Polygon2d.h"
 #ifdef ENABLE_CGAL
@@ -310,6 +313,9 @@ void LogVisitor::printCacheStatistic()
 #ifdef ENABLE_CGAL
   CGALCache::instance()->print();
 #endif
+  ConversionCache::instance()->print();
+  Operation2DCache::instance()->print();
+  SourceFileCache::instance()->print();
 }
 
 void LogVisitor::printRenderingTime(const std::chrono::milliseconds ms)
@@ -418,6 +424,15 @@ void StreamVisitor::printCacheStatistic()
 #ifdef ENABLE_CGAL
     cacheJson["cgal_cache"] = getCache(CGALCache::instance());
 #endif // ENABLE_CGAL
+    auto conversionJson = getCache(ConversionCache::instance());
+    conversionJson["conversions"] = ConversionCache::instance()->conversions();
+    conversionJson["reused"] = ConversionCache::instance()->hits();
+    conversionJson["milliseconds"] = ConversionCache::instance()->conversionTime().count();
+    cacheJson["conversion_cache"] = conversionJson;
+    cacheJson["operation2d_cache"] = getCache(Operation2DCache::instance());
+    auto sourceFileJson = getCache(SourceFileCache::instance());
+    sourceFileJson["evictions"] = SourceFileCache::instance()->evictions();
+    cacheJson["source_file_cache"] = sourceFileJson;
     json["cache"] = cacheJson;
   }
 }
@@ -31,6 +31,8 @@
 #include <memory>
 #include <cmath>
 #include <cstdio>
+#include <string>
+#include <utility>
 #include <vector>
 
 
@@ -38,8 +40,10 @@
 
 #include "utils/printutils.h"
 
+#include "Cache.h"
 #include "FontCache.h"
 #include "core/DrawingCallback.h"
+#include "geometry/Polygon2d.h"
 #include "utils/calc.h"
 
 #include FT_OUTLINE_H
@@ -52,6 +56,39 @@ static inline Vector2d get_scaled_vector(const FT_Vector *ft_vector, double scal
 
 const double FreetypeRenderer::scale = 1e5;
 
+namespace {
+
+struct ShapeCacheEntry {
+  std::shared_ptr<const FreetypeRenderer::GlyphArray> glyphs;
+  bool horizontal;
+};
+
+// Flattened outline of a single glyph at unit size, or nullptr for
+// glyphs without ink (e.g. spaces).
+struct GlyphCacheEntry {
+  std::shared_ptr<const Polygon2d> outline;
+};
+
+// Shaping results keyed by font face, direction, script, language and text.
+Cache<std::string, ShapeCacheEntry> shape_cache(4ul * 1024ul * 1024ul);
+// Glyph outlines keyed by font face, glyph index and number of curve
+// segments. The segment count is derived from size, $fn, $fa and $fs, so
+// those don't need to be part of the key.
+Cache<std::string, GlyphCacheEntry> glyph_cache(32ul * 1024ul * 1024ul);
+
+inline std::string glyph_cache_key(const std::string& face_key, FT_UInt glyph_index, unsigned int segments)
+{
+  return face_key + '\x1f' + std::to_string(glyph_index) + '\x1f' + std::to_string(segments);
+}
+
+} // namespace
+
+void FreetypeRenderer::clear_cache()
+{
+  shape_cache.clear();
+  glyph_cache.clear();
+}
+
 FreetypeRenderer::FreetypeRenderer()
 {
   funcs.move_to = outline_move_to_func;
@@ -321,71 +358,23 @@ void FreetypeRenderer::Params::set(Parameters& parameters)
 FreetypeRenderer::ShapeResults::ShapeResults(
   const FreetypeRenderer::Params& params)
 {
-  FT_Face face = params.get_font_face();
+  face = params.get_font_face();
   if (face == nullptr) {
     return;
   }
 
-  hb_ft_font = hb_ft_font_create(face, nullptr);
-
-  hb_buf = hb_buffer_create();
-  hb_buffer_set_direction(hb_buf, hb_direction_from_string(params.direction.c_str(), -1));
-  hb_buffer_set_script(hb_buf, hb_script_from_string(params.script.c_str(), -1));
-  hb_buffer_set_language(hb_buf, hb_language_from_string(params.language.c_str(), -1));
-  if (FontCache::instance()->is_windows_symbol_font(face)) {
-    // Special handling for symbol fonts like Webdings.
-    // see http://www.microsoft.com/typography/otspec/recom.htm
-    //
-    // We go through the string char by char and if the codepoint
-    // value is between 0x00 and 0xff, then the codepoint is translated
-    // to the 0xf000 page (Private Use Area of Unicode). All other
-    // values are untouched, so using the correct codepoint directly
-    // (e.g. \uf021 for the spider in Webdings) still works.
-    str_utf8_wrapper utf8_str{params.text};
-    if (utf8_str.utf8_validate()) {
-      for (auto ch : utf8_str) {
-        gunichar c = ch.get_utf8_char();
-        c = (c < 0x0100) ? 0xf000 + c : c;
-        hb_buffer_add_utf32(hb_buf, &c, 1, 0, 1);
-      }
-    } else {
-      LOG(message_group::Warning, params.loc, params.documentPath,
-          "Ignoring text with invalid UTF-8 encoding: \"%1$s\"",
-          params.text.c_str());
-    }
-  } else {
-    hb_buffer_add_utf8(hb_buf, params.text.c_str(), strlen(params.text.c_str()), 0, strlen(params.text.c_str()));
-  }
-  hb_shape(hb_ft_font, hb_buf, nullptr, 0);
-
-  unsigned int glyph_count;
-  hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
-  hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
-
-  glyph_array.reserve(glyph_count);
-  for (unsigned int idx = 0; idx < glyph_count; ++idx) {
-    FT_Error error;
-    FT_UInt glyph_index = glyph_info[idx].codepoint;
-    error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
-    if (error) {
-      LOG(message_group::Warning, params.loc, params.documentPath,
-          "Could not load glyph %1$u"
-          " for char at index %2$u in text '%3$s'",
-          glyph_index, idx, params.text);
-      continue;
-    }
-
-    FT_Glyph glyph;
-    error = FT_Get_Glyph(face->glyph, &glyph);
-    if (error) {
-      LOG(message_group::Warning, params.loc, params.documentPath,
-          "Could not get glyph %1$u"
-          " for char at index %2$u in text '%3$s'",
-          glyph_index, idx, params.text);
-      continue;
-    }
-
-    glyph_array.emplace_back(glyph, idx, &glyph_pos[idx]);
+  face_key = params.font + '\x1f' +
+             (face->family_name ? face->family_name : "") + '\x1f' +
+             (face->style_name ? face->style_name : "");
+  const std::string shape_key = face_key + '\x1f' + params.direction +
+                                '\x1f' + params.script + '\x1f' + params.language +
+                                '\x1f' + params.text;
+  if (const auto *entry = shape_cache[shape_key]) {
+    glyph_array = entry->glyphs;
+    horizontal = entry->horizontal;
+  } else if (shape(params)) {
+    size_t cost = sizeof(ShapeCacheEntry) + shape_key.size() + glyph_array->size() * sizeof(GlyphData);
+    shape_cache.insert(shape_key, new ShapeCacheEntry{glyph_array, horizontal}, cost);
   }
 
   ascent = std::numeric_limits<double>::lowest();
@@ -397,9 +386,8 @@ FreetypeRenderer::ShapeResults::ShapeResults(
   bottom = std::numeric_limits<double>::max();
   top = std::numeric_limits<double>::lowest();
 
-  for (const auto& glyph : glyph_array) {
-    FT_BBox bbox;
-    FT_Glyph_Get_CBox(glyph.get_glyph(), FT_GLYPH_BBOX_GRIDFIT, &bbox);
+  for (const auto& glyph : *glyph_array) {
+    const FT_BBox& bbox = glyph.get_cbox();
 
     // Note that glyphs can extend left of their origin
     // and right of their advance-width, into the next
@@ -436,8 +424,7 @@ FreetypeRenderer::ShapeResults::ShapeResults(
   // contributed they will flip.  If they're still reversed,
   // there was no ink.
   if (right >= left) {
-    if (HB_DIRECTION_IS_HORIZONTAL(
-          hb_buffer_get_direction(hb_buf))) {
+    if (horizontal) {
       calc_offsets_horiz(params);
     } else {
       calc_offsets_vert(params);
@@ -456,16 +443,87 @@ FreetypeRenderer::ShapeResults::ShapeResults(
   ok = true;
 }
 
-FreetypeRenderer::ShapeResults::~ShapeResults()
+// Shape the text with HarfBuzz and collect the control box of each glyph.
+// Returns false if anything went wrong, in which case the (partial)
+// result must not be cached so that the warnings are repeated.
+bool FreetypeRenderer::ShapeResults::shape(const FreetypeRenderer::Params& params)
 {
-  if (hb_buf != nullptr) {
-    hb_buffer_destroy(hb_buf);
-    hb_buf = nullptr;
+  bool complete = true;
+  hb_font_t *hb_ft_font = hb_ft_font_create(face, nullptr);
+
+  hb_buffer_t *hb_buf = hb_buffer_create();
+  hb_buffer_set_direction(hb_buf, hb_direction_from_string(params.direction.c_str(), -1));
+  hb_buffer_set_script(hb_buf, hb_script_from_string(params.script.c_str(), -1));
+  hb_buffer_set_language(hb_buf, hb_language_from_string(params.language.c_str(), -1));
+  if (FontCache::instance()->is_windows_symbol_font(face)) {
+    // Special handling for symbol fonts like Webdings.
+    // see http://www.microsoft.com/typography/otspec/recom.htm
+    //
+    // We go through the string char by char and if the codepoint
+    // value is between 0x00 and 0xff, then the codepoint is translated
+    // to the 0xf000 page (Private Use Area of Unicode). All other
+    // values are untouched, so using the correct codepoint directly
+    // (e.g. \uf021 for the spider in Webdings) still works.
+    str_utf8_wrapper utf8_str{params.text};
+    if (utf8_str.utf8_validate()) {
+      for (auto ch : utf8_str) {
+        gunichar c = ch.get_utf8_char();
+        c = (c < 0x0100) ? 0xf000 + c : c;
+        hb_buffer_add_utf32(hb_buf, &c, 1, 0, 1);
+      }
+    } else {
+      LOG(message_group::Warning, params.loc, params.documentPath,
+          "Ignoring text with invalid UTF-8 encoding: \"%1$s\"",
+          params.text.c_str());
+      complete = false;
+    }
+  } else {
+    hb_buffer_add_utf8(hb_buf, params.text.c_str(), strlen(params.text.c_str()), 0, strlen(params.text.c_str()));
   }
-  if (hb_ft_font != nullptr) {
-    hb_font_destroy(hb_ft_font);
-    hb_ft_font = nullptr;
+  hb_shape(hb_ft_font, hb_buf, nullptr, 0);
+  horizontal = HB_DIRECTION_IS_HORIZONTAL(hb_buffer_get_direction(hb_buf));
+
+  unsigned int glyph_count;
+  hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
+  hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
+
+  auto glyphs = std::make_shared<GlyphArray>();
+  glyphs->reserve(glyph_count);
+  for (unsigned int idx = 0; idx < glyph_count; ++idx) {
+    FT_Error error;
+    FT_UInt glyph_index = glyph_info[idx].codepoint;
+    error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
+    if (error) {
+      LOG(message_group::Warning, params.loc, params.documentPath,
+          "Could not load glyph %1$u"
+          " for char at index %2$u in text '%3$s'",
+          glyph_index, idx, params.text);
+      complete = false;
+      continue;
+    }
+
+    FT_Glyph glyph;
+    error = FT_Get_Glyph(face->glyph, &glyph);
+    if (error) {
+      LOG(message_group::Warning, params.loc, params.documentPath,
+          "Could not get glyph %1$u"
+          " for char at index %2$u in text '%3$s'",
+          glyph_index, idx, params.text);
+      complete = false;
+      continue;
+    }
+
+    FT_BBox cbox;
+    FT_Glyph_Get_CBox(glyph, FT_GLYPH_BBOX_GRIDFIT, &cbox);
+    FT_Done_Glyph(glyph);
+
+    glyphs->emplace_back(glyph_index, idx, glyph_pos[idx], cbox);
   }
+  glyph_array = glyphs;
+
+  hb_buffer_destroy(hb_buf);
+  hb_font_destroy(hb_ft_font);
+  return complete;
 }
 
 FreetypeRenderer::FontMetrics::FontMetrics(
@@ -546,6 +604,31 @@ FreetypeRenderer::TextMetrics::TextMetrics(
   ok = true;
 }
 
+std::shared_ptr<const Polygon2d> FreetypeRenderer::get_glyph_outline(const ShapeResults& sr, const GlyphData& glyph, unsigned int segments) const
+{
+  const std::string key = glyph_cache_key(sr.face_key, glyph.get_glyph_index(), segments);
+  if (const auto *entry = glyph_cache[key]) {
+    return entry->outline;
+  }
+
+  if (FT_Load_Glyph(sr.face, glyph.get_glyph_index(), FT_LOAD_DEFAULT) ||
+      sr.face->glyph->format != FT_GLYPH_FORMAT_OUTLINE) {
+    return nullptr;
+  }
+
+  // Flatten at unit size and without offset; instances are placed by render().
+  DrawingCallback callback(segments, 1.0);
+  callback.start_glyph();
+  FT_Outline_Decompose(&sr.face->glyph->outline, &funcs, &callback);
+  callback.finish_glyph();
+  auto polygons = callback.get_result();
+  std::shared_ptr<const Polygon2d> outline = polygons.empty() ? nullptr : polygons.front();
+
+  size_t cost = sizeof(GlyphCacheEntry) + key.size() + (outline ? outline->memsize() : 0);
+  glyph_cache.insert(key, new GlyphCacheEntry{outline}, cost);
+  return outline;
+}
+
 std::vector<std::shared_ptr<const Polygon2d>> FreetypeRenderer::render(const FreetypeRenderer::Params& params) const
 {
   ShapeResults sr(params);
@@ -554,23 +637,37 @@ std::vector<std::shared_ptr<const Polygon2d>> FreetypeRenderer::render(const Fre
     return {};
   }
 
-  DrawingCallback callback(params.segments, params.size);
-  for (const auto& glyph : sr.glyph_array) {
-    callback.start_glyph();
-    callback.set_glyph_offset(
-      sr.x_offset + glyph.get_x_offset(),
-      sr.y_offset + glyph.get_y_offset());
-    FT_Outline outline = reinterpret_cast<FT_OutlineGlyph>(glyph.get_glyph())->outline;
-    FT_Outline_Decompose(&outline, &funcs, &callback);
+  std::vector<std::shared_ptr<const Polygon2d>> result;
+  Vector2d advance(0, 0);
+  for (const auto& glyph : *sr.glyph_array) {
+    const auto outline = get_glyph_outline(sr, glyph, params.segments);
+    if (outline) {
+      // Place the cached unit-size glyph. This matches the arithmetic of
+      // DrawingCallback::add_vertex() so the result is identical to
+      // flattening the glyph in place.
+      const Vector2d offset(sr.x_offset + glyph.get_x_offset(),
+                            sr.y_offset + glyph.get_y_offset());
+      auto polygon = std::make_shared<Polygon2d>();
+      // FIXME: Why do we think that a glyph is sanitized? See DrawingCallback::start_glyph().
+      polygon->setSanitized(true);
+      for (const auto& o : outline->outlines()) {
+        Outline2d placed;
+        placed.vertices.reserve(o.vertices.size());
+        for (const auto& v : o.vertices) {
+          placed.vertices.push_back(params.size * (v + offset + advance));
+        }
+        polygon->addOutline(std::move(placed));
+      }
+      result.push_back(polygon);
+    }
 
     double adv_x = glyph.get_x_advance() * params.spacing;
     double adv_y = glyph.get_y_advance() * params.spacing;
-    callback.add_glyph_advance(adv_x, adv_y);
-    callback.finish_glyph();
+    advance += Vector2d(adv_x, adv_y);
   }
 
   // FIXME: The returned Polygon2d currently contains only outlines with the 'positive' flag set to true,
   // and where the winding order determines if the outlines should be interpreted as polygons or holes.
   // We have to rely on any downstream processing to be aware of the winding order, and ignore the 'positive' flag.
-  return callback.get_result();
+  return result;
 }
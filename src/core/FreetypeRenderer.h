@@ -154,34 +154,41 @@ public:
     std::string style_name;
     FontMetrics(const FreetypeRenderer::Params& params);
   };
-  FreetypeRenderer();
-  virtual ~FreetypeRenderer() = default;
 
-  [[nodiscard]] std::vector<std::shared_ptr<const class Polygon2d>> render(const FreetypeRenderer::Params& params) const;
-private:
-  const static double scale;
-  FT_Outline_Funcs funcs;
-
-  // The GlyphData assumes responsibility for "glyph" and will ensure
-  // that it is freed when the GlyphData is destroyed.
-  // However, glyph_pos points to data that the caller must ensure
-  // remains valid until the GlyphData is destroyed.
+  // A glyph as positioned by HarfBuzz, together with its grid-fitted
+  // control box. Shaping results are cached per string and font, so
+  // this holds plain values rather than pointers into a hb_buffer_t.
   class GlyphData
   {
 public:
-    GlyphData(FT_Glyph glyph, unsigned int idx, hb_glyph_position_t *glyph_pos) : glyph(glyph), idx(idx), glyph_pos(glyph_pos) {}
+    GlyphData(FT_UInt glyph_index, unsigned int idx, const hb_glyph_position_t& glyph_pos, const FT_BBox& cbox)
+      : glyph_index(glyph_index), idx(idx), x_offset(glyph_pos.x_offset), y_offset(glyph_pos.y_offset),
+      x_advance(glyph_pos.x_advance), y_advance(glyph_pos.y_advance), cbox(cbox) {}
+    [[nodiscard]] FT_UInt get_glyph_index() const { return glyph_index; }
     [[nodiscard]] unsigned int get_idx() const { return idx; }
-    [[nodiscard]] FT_Glyph get_glyph() const { return glyph; }
-    [[nodiscard]] double get_x_offset() const { return glyph_pos->x_offset / scale; }
-    [[nodiscard]] double get_y_offset() const { return glyph_pos->y_offset / scale; }
-    [[nodiscard]] double get_x_advance() const { return glyph_pos->x_advance / scale; }
-    [[nodiscard]] double get_y_advance() const { return glyph_pos->y_advance / scale; }
-    ~GlyphData() { FT_Done_Glyph(glyph); }
+    [[nodiscard]] const FT_BBox& get_cbox() const { return cbox; }
+    [[nodiscard]] double get_x_offset() const { return x_offset / scale; }
+    [[nodiscard]] double get_y_offset() const { return y_offset / scale; }
+    [[nodiscard]] double get_x_advance() const { return x_advance / scale; }
+    [[nodiscard]] double get_y_advance() const { return y_advance / scale; }
 private:
-    FT_Glyph glyph;
+    FT_UInt glyph_index;
     unsigned int idx;
-    hb_glyph_position_t *glyph_pos;
+    hb_position_t x_offset, y_offset, x_advance, y_advance;
+    FT_BBox cbox;
   };
+  using GlyphArray = std::vector<GlyphData>;
+
+  FreetypeRenderer();
+  virtual ~FreetypeRenderer() = default;
+
+  [[nodiscard]] std::vector<std::shared_ptr<const class Polygon2d>> render(const FreetypeRenderer::Params& params) const;
+
+  // Drop all cached shaping results and flattened glyph outlines.
+  static void clear_cache();
+private:
+  const static double scale;
+  FT_Outline_Funcs funcs;
 
   class ShapeResults
   {
@@ -191,7 +198,7 @@ public:
     // They have been downscaled from the 1e+5 unit size used for
     // when rendering from Freetype, and have not yet been scaled
     // back up to the desired font size.
-    std::vector<GlyphData> glyph_array;
+    std::shared_ptr<const GlyphArray> glyph_array;
     double x_offset{0.0};
     double y_offset{0.0};
     double left{0.0};
@@ -202,15 +209,21 @@ public:
     double advance_y{0.0};
     double ascent{0.0};
     double descent{0.0};
+    // The face the glyphs were shaped with, and a key identifying it
+    // in the glyph outline cache.
+    FT_Face face{nullptr};
+    std::string face_key;
     ShapeResults(const FreetypeRenderer::Params& params);
-    virtual ~ShapeResults();
+    virtual ~ShapeResults() = default;
 private:
+    bool shape(const FreetypeRenderer::Params& params);
     void calc_offsets_horiz(const FreetypeRenderer::Params& params);
     void calc_offsets_vert(const FreetypeRenderer::Params& params);
-    hb_font_t *hb_ft_font{nullptr};
-    hb_buffer_t *hb_buf{nullptr};
+    bool horizontal{true};
   };
 
+  [[nodiscard]] std::shared_ptr<const class Polygon2d> get_glyph_outline(const ShapeResults& sr, const GlyphData& glyph, unsigned int segments) const;
+
   static int outline_move_to_func(const FT_Vector *to, void *user);
   static int outline_line_to_func(const FT_Vector *to, void *user);
   static int outline_conic_to_func(const FT_Vector *c1, const FT_Vector *to, void *user);
@@ -170,6 +170,7 @@ time_t SourceFile::handleDependencies(bool is_root)
     auto pos = std::find(usedlibs.begin(), usedlibs.end(), files.first);
     if (pos != usedlibs.end()) *pos = files.second;
   }
+  if (is_root) SourceFileCache::instance()->evict();
   return latest;
 }
 
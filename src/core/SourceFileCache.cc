@@ -12,10 +12,6 @@
 #include <sys/stat.h>
 #include <algorithm>
 
-/*!
-   FIXME: Implement an LRU scheme to avoid having an ever-growing source file cache
- */
-
 SourceFileCache *SourceFileCache::inst = nullptr;
 
 /*!
@@ -39,6 +35,12 @@ std::time_t SourceFileCache::evaluate(const std::string& mainFile, const std::st
   // during evaluation, that would be really bad.
   if (file && file->isHandlingDependencies()) return 0;
 
+  // Mark as used, also when keeping an old version below
+  if (found) {
+    entry->second.last_access = ++this->access_counter;
+    entry->second.generation = this->generation;
+  }
+
   // Create cache ID
   struct stat st;
   bool valid = (StatCache::stat(filename, st) == 0);
@@ -58,6 +60,10 @@ std::time_t SourceFileCache::evaluate(const std::string& mainFile, const std::st
     cacheEntry.includes_mtime = st.st_mtime;
   }
   cacheEntry.mtime = st.st_mtime;
+  if (!found) {
+    cacheEntry.last_access = ++this->access_counter;
+    cacheEntry.generation = this->generation;
+  }
 
   bool shouldCompile = true;
   if (found) {
@@ -107,6 +113,8 @@ std::time_t SourceFileCache::evaluate(const std::string& mainFile, const std::st
     PRINTDB("compiled file: %s", filename);
     cacheEntry.file = file;
     cacheEntry.cache_id = cache_id;
+    this->total_cost += text.size() - cacheEntry.cost;
+    cacheEntry.cost = text.size();
     auto mod = file ? file : cacheEntry.parsed_file;
     if (!found && mod) cacheEntry.includes_mtime = mod->includesChanged();
     print_messages_pop();
@@ -119,9 +127,45 @@ std::time_t SourceFileCache::evaluate(const std::string& mainFile, const std::st
   return std::max({deps_mtime, cacheEntry.mtime, cacheEntry.includes_mtime});
 }
 
+/*!
+   Evicts least recently used libraries until the cache fits its budget.
+   Should be called after the root file's dependencies have been handled.
+ */
+void SourceFileCache::evict()
+{
+  while (this->total_cost > this->max_cost) {
+    auto victim = this->entries.end();
+    for (auto it = this->entries.begin(); it != this->entries.end(); ++it) {
+      const auto& entry = it->second;
+      if (entry.generation + 1 >= this->generation) continue; // possibly in use
+      if (entry.file && entry.file->isHandlingDependencies()) continue;
+      if (victim == this->entries.end() || entry.last_access < victim->second.last_access) victim = it;
+    }
+    if (victim == this->entries.end()) break;
+
+    PRINTDB("Evicting cached library: %s", victim->first);
+    this->total_cost -= victim->second.cost;
+    delete victim->second.parsed_file;
+    this->entries.erase(victim);
+    this->num_evictions++;
+  }
+}
+
+void SourceFileCache::setMaxSizeMB(size_t limit)
+{
+  this->max_cost = limit * 1024ul * 1024ul;
+}
+
 void SourceFileCache::clear()
 {
   this->entries.clear();
+  this->total_cost = 0;
+}
+
+void SourceFileCache::print()
+{
+  LOG("Libraries in cache: %1$d (%2$d evicted)", this->entries.size(), this->num_evictions);
+  LOG("Library cache size in bytes of source: %1$d", this->total_cost);
 }
 
 SourceFile *SourceFileCache::lookup(const std::string& filename)
@@ -131,6 +175,7 @@ SourceFile *SourceFileCache::lookup(const std::string& filename)
 }
 
 void SourceFileCache::clear_markers() {
+  instance()->generation++;
   for (const auto& entry : instance()->entries)
     if (auto lib = entry.second.file) lib->clearHandlingDependencies();
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <ctime>
 #include <unordered_map>
@@ -7,7 +9,12 @@
 class SourceFile;
 
 /*!
-   Caches SourceFiles based on their filenames
+   Caches SourceFiles based on their filenames.
+
+   The cache is bounded by the size of the cached sources, which the parsed
+   AST scales with. Least recently used libraries are evicted, but only those
+   not used by the current or the previous root file, since instantiated
+   nodes of the model being shown may still refer to their AST.
  */
 class SourceFileCache
 {
@@ -17,7 +24,13 @@ public:
   std::time_t evaluate(const std::string& mainFile, const std::string& filename, SourceFile *& sourceFile);
   SourceFile *lookup(const std::string& filename);
   size_t size() const { return this->entries.size(); }
+  size_t totalCost() const { return this->total_cost; }
+  size_t maxSizeMB() const { return this->max_cost / (1024ul * 1024ul); }
+  void setMaxSizeMB(size_t limit);
+  size_t evictions() const { return this->num_evictions; }
+  void evict();
   void clear();
+  void print();
   static void clear_markers();
 
 private:
@@ -31,6 +44,14 @@ private:
     std::string cache_id;
     std::time_t mtime{}; // time file last modified
     std::time_t includes_mtime{}; // time the includes last changed
+    std::size_t cost{}; // size of the source text last compiled
+    std::uint64_t last_access{};
+    std::uint64_t generation{}; // last root file evaluation using this entry
   };
   std::unordered_map<std::string, cache_entry> entries;
+  size_t total_cost{0};
+  size_t max_cost{64ul * 1024ul * 1024ul};
+  size_t num_evictions{0};
+  std::uint64_t access_counter{0};
+  std::uint64_t generation{0};
 };
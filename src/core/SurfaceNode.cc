@@ -30,17 +30,19 @@
 #include "core/ModuleInstantiation.h"
 #include "core/node.h"
 #include "geometry/PolySet.h"
-#include "geometry/PolySetBuilder.h"
 #include "core/Builtins.h"
 #include "core/Children.h"
 #include "core/Parameters.h"
+#include "Feature.h"
 #include "utils/printutils.h"
 #include "io/fileutils.h"
 #include "handle_dep.h"
+#include "utils/parallel.h"
 #include "lodepng/lodepng.h"
 
 #include <algorithm>
 #include <cstring>
+#include <numeric>
 #include <new>
 #include <string>
 #include <utility>
@@ -50,9 +52,7 @@
 #include <sstream>
 #include <fstream>
 #include <vector>
-#include <unordered_map>
 
-#include <boost/functional/hash.hpp>
 #include <boost/tokenizer.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
@@ -89,18 +89,20 @@ static std::shared_ptr<AbstractNode> builtin_surface(const ModuleInstantiation *
   return node;
 }
 
-void SurfaceNode::convert_image(img_data_t& data, std::vector<uint8_t>& img, unsigned int width, unsigned int height) const
+void SurfaceNode::convert_image(img_data_t& data, const std::vector<uint8_t>& img, unsigned int width, unsigned int height) const
 {
   data.width = width;
   data.height = height;
   data.resize( (size_t)width * height);
   double min_val = 200;
   for (unsigned int y = 0; y < height; ++y) {
+    const uint8_t *row = img.data() + 3ul * width * y;
+    auto *out = &data.storage[(size_t)width * (height - 1 - y)];
     for (unsigned int x = 0; x < width; ++x) {
-      long idx = 4l * (y * width + x);
-      double pixel = 0.2126 * img[idx] + 0.7152 * img[idx + 1] + 0.0722 * img[idx + 2];
+      const uint8_t *px = row + 3ul * x;
+      double pixel = 0.2126 * px[0] + 0.7152 * px[1] + 0.0722 * px[2];
       double z = 100.0 / 255 * (invert ? 1 - pixel : pixel);
-      data[ x + (width * (height - 1 - y)) ] = z;
+      out[x] = z;
       min_val = std::min(z, min_val);
     }
   }
@@ -118,31 +120,32 @@ bool SurfaceNode::is_png(std::vector<uint8_t>& png) const
 img_data_t SurfaceNode::read_png_or_dat(std::string filename) const
 {
   img_data_t data;
-  std::vector<uint8_t> png;
-  int ret_val = 0;
-  try{
-    ret_val = lodepng::load_file(png, filename);
-  } catch (std::bad_alloc& ba) {
-    LOG(message_group::Warning, "bad_alloc caught for '%1$s'.", ba.what());
-    return data;
-  }
-
-  if (ret_val == 78) {
-    LOG(message_group::Warning, "The file '%1$s' couldn't be opened.", filename);
-    return data;
-  }
-
-  if (!is_png(png)) {
-    png.clear();
-    return read_dat(filename);
-  }
-
   unsigned int width, height;
   std::vector<uint8_t> img;
-  auto error = lodepng::decode(img, width, height, png);
-  if (error) {
-    LOG(message_group::Warning, "Can't read PNG image '%1$s'", filename);
-    data.clear();
+  try {
+    std::vector<uint8_t> png;
+    int ret_val = lodepng::load_file(png, filename);
+    if (ret_val == 78) {
+      LOG(message_group::Warning, "The file '%1$s' couldn't be opened.", filename);
+      return data;
+    }
+
+    if (!is_png(png)) {
+      png.clear();
+      png.shrink_to_fit();
+      return read_dat(filename);
+    }
+
+    // Only the colour channels are used, so decode straight to 24-bit RGB.
+    // The compressed file buffer is released when leaving this scope, before
+    // the height data is allocated.
+    auto error = lodepng::decode(img, width, height, png, LCT_RGB, 8);
+    if (error) {
+      LOG(message_group::Warning, "Can't read PNG image '%1$s'", filename);
+      return data;
+    }
+  } catch (std::bad_alloc& ba) {
+    LOG(message_group::Warning, "bad_alloc caught for '%1$s'.", ba.what());
     return data;
   }
 
@@ -161,16 +164,17 @@ img_data_t SurfaceNode::read_dat(std::string filename) const
     return data;
   }
 
-  int lines = 0, columns = 0;
+  size_t lines = 0, columns = 0;
   double min_val = 1; // this balances out with the (min_val-1) inside createGeometry, to match old behavior
 
   using tokenizer = boost::tokenizer<boost::char_separator<char>>;
   boost::char_separator<char> sep(" \t");
 
-  // We use an unordered map because the data file may not be rectangular,
-  // and we may need to fill in some bits.
-  using unordered_image_data_t = std::unordered_map<std::pair<int, int>, double, boost::hash<std::pair<int, int>>>;
-  unordered_image_data_t unordered_data;
+  // Values are appended row by row into a single buffer. The data file may
+  // not be rectangular, so remember where each row starts and pad the short
+  // rows in place once the final number of columns is known.
+  std::vector<double>& values = data.storage;
+  std::vector<size_t> row_start;
 
   while (!stream.eof()) {
     std::string line;
@@ -180,21 +184,22 @@ img_data_t SurfaceNode::read_dat(std::string filename) const
     }
     if (line.size() == 0 && stream.eof()) break;
 
-    int col = 0;
+    row_start.push_back(values.size());
     tokenizer tokens(line, sep);
     try {
       for (const auto& token : tokens) {
         auto v = boost::lexical_cast<double>(token);
-        unordered_data[ std::make_pair(lines, col++) ] = v;
-        if (col > columns) columns = col;
+        values.push_back(v);
         min_val = std::min(v, min_val);
       }
     } catch (const boost::bad_lexical_cast& blc) {
       if (!stream.eof()) {
         LOG(message_group::Warning, "Illegal value in '%1$s': %2$s", filename, blc.what());
       }
+      data.clear();
       return data;
     }
+    columns = std::max(columns, values.size() - row_start.back());
 
     lines++;
   }
@@ -203,127 +208,205 @@ img_data_t SurfaceNode::read_dat(std::string filename) const
   data.height = lines;
   data.min_val = min_val;
 
-  // Now convert the unordered, possibly non-rectangular data into a well ordered vector
-  // for faster access and reduced memory usage.
-  data.resize( (size_t)lines * columns);
-  for (int i = 0; i < lines; ++i)
-    for (int j = 0; j < columns; ++j)
-      data[ i * columns + j ] = unordered_data[std::make_pair(i, j)];
+  if (values.size() != lines * columns) {
+    // Spread the rows out back to front so that no row is overwritten before
+    // it has been moved, filling the missing values with zero.
+    size_t end = values.size();
+    values.resize(lines * columns, 0.0);
+    for (size_t i = lines; i-- > 0;) {
+      size_t len = end - row_start[i];
+      std::copy_backward(values.begin() + row_start[i], values.begin() + end, values.begin() + i * columns + len);
+      std::fill(values.begin() + i * columns + len, values.begin() + (i + 1) * columns, 0.0);
+      end = row_start[i];
+    }
+  }
 
   return data;
 }
 
-// FIXME: Look for faster way to generate PolySet directly
+namespace {
+
+// Index arithmetic for the vertices of a heightmap mesh: the grid points come
+// first in row-major order, followed by the points on the bottom face, which
+// is one less than the minimum value. The bottom points are stored in the
+// order they are visited by the bottom polygon.
+struct SurfaceGrid
+{
+  int lines;
+  int columns;
+
+  [[nodiscard]] int top(int x, int y) const { return y * columns + x; }
+
+  [[nodiscard]] int numBottom() const {
+    if (lines < 2 || columns < 2) return lines * columns;
+    return 2 * (columns - 1) + 2 * (lines - 1);
+  }
+
+  // Only valid for points on the perimeter of the grid
+  [[nodiscard]] int bottom(int x, int y) const {
+    const int base = lines * columns;
+    if (lines < 2 || columns < 2) return base + top(x, y);
+    if (x == 0 && y < lines - 1) return base + y;
+    if (y == lines - 1 && x < columns - 1) return base + (lines - 1) + x;
+    if (x == columns - 1 && y > 0) return base + (lines - 1) + (columns - 1) + (lines - 1 - y);
+    return base + 2 * (lines - 1) + (columns - 1) + (columns - 1 - x);
+  }
+
+  [[nodiscard]] int numVertices() const { return lines * columns + numBottom(); }
+};
+
+// Whether the four corners of a cell lie in one plane. In that case the
+// centre vertex is on the same plane and the cell doesn't need to be split.
+bool isPlanarCell(double v1, double v2, double v3, double v4)
+{
+  return v1 + v4 == v2 + v3;
+}
+
+} // namespace
+
 std::unique_ptr<const Geometry> SurfaceNode::createGeometry() const
 {
   auto data = read_png_or_dat(filename);
 
-  int lines = data.height;
-  int columns = data.width;
-  double min_val = data.min_value() - 1; // make the bottom solid, and match old code
+  const int lines = data.height;
+  const int columns = data.width;
+  const double min_val = data.min_value() - 1; // make the bottom solid, and match old code
 
-  // reserve the polygon vector size so we don't have to reallocate as often
+  auto ps = std::make_unique<PolySet>(3);
+  ps->setConvexity(convexity);
+  // A single height value doesn't span any face, so it has no vertices either
+  if (lines == 0 || columns == 0 || (lines == 1 && columns == 1)) return ps;
 
-  double ox = center ? -(columns - 1) / 2.0 : 0;
-  double oy = center ? -(lines - 1) / 2.0 : 0;
+  const double ox = center ? -(columns - 1) / 2.0 : 0;
+  const double oy = center ? -(lines - 1) / 2.0 : 0;
 
-  int num_indices = (lines - 1) * (columns - 1) * 4 + (lines - 1) * 2 + (columns - 1) * 2 + 1;
-  PolySetBuilder builder(0, num_indices);
-  builder.setConvexity(convexity);
-  // the bulk of the heightmap
-  for (int i = 1; i < lines; ++i)
-    for (int j = 1; j < columns; ++j) {
-      double v1 = data[ (j - 1) + (i - 1) * columns ];
-      double v2 = data[ (j) + (i - 1) * columns ];
-      double v3 = data[ (j - 1) + (i) * columns ];
-      double v4 = data[ (j) + (i) * columns ];
-
-      double vx = (v1 + v2 + v3 + v4) / 4;
-
-      builder.appendPolygon({
-                Vector3d(ox + j - 1, oy + i - 1, v1),
-                Vector3d(ox + j, oy + i - 1, v2),
-                Vector3d(ox + j - 0.5, oy + i - 0.5, vx)
-                });
-
-      builder.appendPolygon({
-                Vector3d(ox + j, oy + i - 1, v2),
-                Vector3d(ox + j, oy + i, v4),
-                Vector3d(ox + j - 0.5, oy + i - 0.5, vx)
-                });
-
-      builder.appendPolygon({
-                Vector3d(ox + j, oy + i, v4),
-                Vector3d(ox + j - 1, oy + i, v3),
-                Vector3d(ox + j - 0.5, oy + i - 0.5, vx)
-                });
-
-      builder.appendPolygon({
-                Vector3d(ox + j - 1, oy + i, v3),
-                Vector3d(ox + j - 1, oy + i - 1, v1),
-                Vector3d(ox + j - 0.5, oy + i - 0.5, vx)
-                });
-    }
+  const SurfaceGrid grid{lines, columns};
+  const bool decimate = Feature::ExperimentalSurfaceDecimation.is_enabled();
+  const size_t num_cells = (size_t)(lines - 1) * (columns - 1);
 
-  // edges along Y
-  for (int i = 1; i < lines; ++i) {
-    double v1 = data[ (0) + (i - 1) * columns ];
-    double v2 = data[ (0) + (i) * columns ];
-    double v3 = data[ (columns - 1) + (i - 1) * columns ];
-    double v4 = data[ (columns - 1) + (i) * columns ];
+  auto& vertices = ps->vertices;
+  auto& indices = ps->indices;
+  vertices.resize(grid.numVertices() + (decimate ? 0 : num_cells));
 
+  parallelizable_for(0, lines, [&](size_t i) {
+    for (int j = 0; j < columns; ++j) {
+      vertices[grid.top(j, i)] = Vector3d(ox + j, oy + i, data[j + i * columns]);
+    }
+  });
+  for (int i = 0; i < lines; ++i) {
+    for (int j = 0; j < columns; ++j) {
+      if (i == 0 || j == 0 || i == lines - 1 || j == columns - 1) {
+        vertices[grid.bottom(j, i)] = Vector3d(ox + j, oy + i, min_val);
+      }
+    }
+  }
 
-    builder.appendPolygon({
-        Vector3d(ox + 0, oy + i - 1, min_val),
-        Vector3d(ox + 0, oy + i - 1, v1),
-        Vector3d(ox + 0, oy + i, v2),
-        Vector3d(ox + 0, oy + i, min_val)
+  // the bulk of the heightmap
+  if (!decimate) {
+    // Four triangles around a centre vertex for each cell
+    const int center_base = grid.numVertices();
+    indices.resize(num_cells * 4);
+    parallelizable_for(1, lines, [&](size_t i) {
+      for (int j = 1; j < columns; ++j) {
+        const size_t cell = (i - 1) * (columns - 1) + (j - 1);
+        const int c = center_base + cell;
+        const double vx = (data[(j - 1) + (i - 1) * columns] + data[j + (i - 1) * columns] +
+                           data[(j - 1) + i * columns] + data[j + i * columns]) / 4;
+        vertices[c] = Vector3d(ox + j - 0.5, oy + i - 0.5, vx);
+
+        const int p1 = grid.top(j - 1, i - 1), p2 = grid.top(j, i - 1);
+        const int p3 = grid.top(j - 1, i), p4 = grid.top(j, i);
+        auto out = indices.begin() + cell * 4;
+        *out++ = {p1, p2, c};
+        *out++ = {p2, p4, c};
+        *out++ = {p4, p3, c};
+        *out++ = {p3, p1, c};
+      }
     });
+  } else {
+    // Rectangles of cells which share the same plane become a single face.
+    // Cells are merged greedily: a run of matching cells is grown along the
+    // row, and then extended over the following rows for as long as the whole
+    // run matches. Each face keeps every grid point along its perimeter, so
+    // neighbouring faces don't end up with T-junctions. Cells which aren't
+    // planar are split around a centre vertex as usual.
+    const auto value = [&](int x, int y) { return data[x + y * columns]; };
+    // Whether cell (x, y) is planar and has the gradient (dx, dy)
+    const auto matches = [&](int x, int y, double dx, double dy) {
+      const double w1 = value(x - 1, y - 1), w2 = value(x, y - 1);
+      const double w3 = value(x - 1, y), w4 = value(x, y);
+      return isPlanarCell(w1, w2, w3, w4) && w2 - w1 == dx && w3 - w1 == dy;
+    };
+    std::vector<bool> merged(num_cells, false);
+    const auto cell = [&](int x, int y) { return (size_t)(y - 1) * (columns - 1) + (x - 1); };
+    indices.reserve(num_cells);
+    for (int i = 1; i < lines; ++i) {
+      for (int j = 1; j < columns; ++j) {
+        if (merged[cell(j, i)]) continue;
+        const double v1 = value(j - 1, i - 1), v2 = value(j, i - 1);
+        const double v3 = value(j - 1, i), v4 = value(j, i);
+        if (!isPlanarCell(v1, v2, v3, v4)) {
+          const int c = vertices.size();
+          vertices.emplace_back(ox + j - 0.5, oy + i - 0.5, (v1 + v2 + v3 + v4) / 4);
+          const int p1 = grid.top(j - 1, i - 1), p2 = grid.top(j, i - 1);
+          const int p3 = grid.top(j - 1, i), p4 = grid.top(j, i);
+          indices.push_back({p1, p2, c});
+          indices.push_back({p2, p4, c});
+          indices.push_back({p4, p3, c});
+          indices.push_back({p3, p1, c});
+          continue;
+        }
+
+        const double dx = v2 - v1;
+        const double dy = v3 - v1;
+        int x_end = j + 1;
+        while (x_end < columns && !merged[cell(x_end, i)] && matches(x_end, i, dx, dy)) ++x_end;
+        int y_end = i + 1;
+        for (; y_end < lines; ++y_end) {
+          bool row_matches = true;
+          for (int k = j; k < x_end && row_matches; ++k) {
+            row_matches = !merged[cell(k, y_end)] && matches(k, y_end, dx, dy);
+          }
+          if (!row_matches) break;
+        }
+        for (int y = i; y < y_end; ++y) {
+          for (int x = j; x < x_end; ++x) merged[cell(x, y)] = true;
+        }
+
+        // Walk the perimeter of grid points from (j - 1, i - 1) to (x_end - 1, y_end - 1)
+        IndexedFace face;
+        face.reserve(2 * (x_end - j) + 2 * (y_end - i));
+        for (int k = j - 1; k < x_end; ++k) face.push_back(grid.top(k, i - 1));
+        for (int k = i; k < y_end; ++k) face.push_back(grid.top(x_end - 1, k));
+        for (int k = x_end - 2; k >= j - 1; --k) face.push_back(grid.top(k, y_end - 1));
+        for (int k = y_end - 2; k >= i; --k) face.push_back(grid.top(j - 1, k));
+        indices.push_back(std::move(face));
+      }
+    }
+  }
 
-    builder.appendPolygon({
-        Vector3d(ox + columns - 1, oy + i, min_val),
-        Vector3d(ox + columns - 1, oy + i, v4),
-        Vector3d(ox + columns - 1, oy + i - 1, v3),
-        Vector3d(ox + columns - 1, oy + i - 1, min_val)
-    });
+  // edges along Y
+  for (int i = 1; i < lines; ++i) {
+    indices.push_back({grid.bottom(0, i - 1), grid.top(0, i - 1), grid.top(0, i), grid.bottom(0, i)});
+    indices.push_back({grid.bottom(columns - 1, i), grid.top(columns - 1, i),
+                       grid.top(columns - 1, i - 1), grid.bottom(columns - 1, i - 1)});
   }
 
   // edges along X
   for (int i = 1; i < columns; ++i) {
-    double v1 = data[ (i - 1) + (0) * columns ];
-    double v2 = data[ (i) + (0) * columns ];
-    double v3 = data[ (i - 1) + (lines - 1) * columns ];
-    double v4 = data[ (i) + (lines - 1) * columns ];
-
-    builder.appendPolygon({
-        Vector3d(ox + i, oy + 0, min_val),
-        Vector3d(ox + i, oy + 0, v2),
-        Vector3d(ox + i - 1, oy + 0, v1),
-        Vector3d(ox + i - 1, oy + 0, min_val)
-    });
-
-    builder.appendPolygon({
-        Vector3d(ox + i - 1, oy + lines - 1, min_val),
-        Vector3d(ox + i - 1, oy + lines - 1, v3),
-        Vector3d(ox + i, oy + lines - 1, v4),
-        Vector3d(ox + i, oy + lines - 1, min_val)
-    });
+    indices.push_back({grid.bottom(i, 0), grid.top(i, 0), grid.top(i - 1, 0), grid.bottom(i - 1, 0)});
+    indices.push_back({grid.bottom(i - 1, lines - 1), grid.top(i - 1, lines - 1),
+                       grid.top(i, lines - 1), grid.bottom(i, lines - 1)});
   }
 
   // the bottom of the shape (one less than the real minimum value), making it a solid volume
   if (columns > 1 && lines > 1) {
-    builder.beginPolygon(2 * (columns - 1) + 2 * (lines - 1) );
-    for (int i = 0; i < lines - 1; ++i)
-      builder.addVertex(Vector3d(ox + 0, oy + i, min_val));
-    for (int i = 0; i < columns - 1; ++i)
-      builder.addVertex(Vector3d(ox + i, oy + lines - 1, min_val));
-    for (int i = lines - 1; i > 0; i--)
-      builder.addVertex(Vector3d(ox + columns - 1, oy + i, min_val));
-    for (int i = columns - 1; i > 0; i--)
-      builder.addVertex(Vector3d(ox + i, oy + 0, min_val));
+    IndexedFace bottom(grid.numBottom());
+    std::iota(bottom.begin(), bottom.end(), lines * columns);
+    indices.push_back(std::move(bottom));
   }
 
-  return builder.build();
+  return ps;
 }
 
 std::string SurfaceNode::toString() const
@@ -74,7 +74,7 @@ public:
 
   std::unique_ptr<const Geometry> createGeometry() const override;
 private:
-  void convert_image(img_data_t& data, std::vector<uint8_t>& img, unsigned int width, unsigned int height) const;
+  void convert_image(img_data_t& data, const std::vector<uint8_t>& img, unsigned int width, unsigned int height) const;
   bool is_png(std::vector<uint8_t>& img) const;
   img_data_t read_dat(std::string filename) const;
   img_data_t read_png_or_dat(std::string filename) const;
@@ -192,6 +192,9 @@ namespace OGL {
     unsigned number_of_facet_cycles() const
     { return fc_ends_.size(); }
 
+    std::size_t number_of_vertices() const
+    { return coords_.size(); }
+
     Coord_iterator facet_cycle_begin(unsigned i) 
     { CGAL_assertion(i<number_of_facet_cycles());
       if (i==0) return coords_.begin();
@@ -354,6 +357,24 @@ namespace OGL {
     { edges_.push_back(DSegment(s,m)); }
     void push_back(const DFacet& f) 
     { halffacets_.push_back(f); }
+
+    // The converted geometry, without any GL state
+    const std::list<DPoint>& vertices() const { return vertices_; }
+    const std::list<DSegment>& edges() const { return edges_; }
+    const std::list<DFacet>& halffacets() const { return halffacets_; }
+
+    std::size_t memsize() const {
+      std::size_t mem = sizeof(Polyhedron);
+      // std::list nodes hold two pointers besides the element
+      mem += vertices_.size() * (sizeof(DPoint) + 2 * sizeof(void *));
+      mem += edges_.size() * (sizeof(DSegment) + 2 * sizeof(void *));
+      for (const auto& f : halffacets_) {
+        mem += sizeof(DFacet) + 2 * sizeof(void *);
+        mem += f.number_of_vertices() * sizeof(Double_triple);
+        mem += f.number_of_facet_cycles() * sizeof(unsigned);
+      }
+      return mem;
+    }
  
     void toggle(int index) override { 
       switches[index] = !switches[index]; 
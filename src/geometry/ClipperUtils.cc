@@ -1,11 +1,14 @@
 #include "geometry/ClipperUtils.h"
 #include "clipper2/clipper.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
+#include "Feature.h"
 
 #include <algorithm>
 #include <clipper2/clipper.engine.h>
 #include <cmath>
 #include <cassert>
+#include <iterator>
 #include <utility>
 #include <memory>
 #include <cstddef>
@@ -95,6 +98,68 @@ void fill_minkowski_insides(const Clipper2Lib::Paths64& a,
   }
 }
 
+/*!
+   If poly is a regular polygon, e.g. a circle(), return its center and circumradius.
+ */
+bool getRegularPolygon(const Polygon2d& poly, Vector2d& center, double& radius)
+{
+  if (poly.outlines().size() != 1) return false;
+  const auto& vertices = poly.outlines()[0].vertices;
+  if (vertices.size() < 3) return false;
+
+  center = Vector2d::Zero();
+  for (const auto& v : vertices) center += v;
+  center /= static_cast<double>(vertices.size());
+
+  radius = (vertices[0] - center).norm();
+  const double edge = (vertices[1] - vertices[0]).norm();
+  const double eps = 1e-9 * radius;
+  if (radius == 0) return false;
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    const auto& v = vertices[i];
+    const auto& next = vertices[(i + 1) % vertices.size()];
+    if (std::abs((v - center).norm() - radius) > eps) return false;
+    if (std::abs((next - v).norm() - edge) > eps) return false;
+  }
+  return true;
+}
+
+/*!
+   Union a large soup of paths, e.g. the projected faces of a mesh.
+   The paths are split into chunks which are unioned in parallel, and the
+   partial results are then merged pairwise, also in parallel.
+ */
+Clipper2Lib::Paths64 parallelUnion(Clipper2Lib::Paths64 paths)
+{
+  constexpr size_t chunk_size = 4096;
+  if (paths.size() <= chunk_size) {
+    return process(paths, Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero);
+  }
+
+  std::vector<Clipper2Lib::Paths64> parts((paths.size() + chunk_size - 1) / chunk_size);
+  parallelizable_for(size_t{0}, parts.size(), [&](size_t i) {
+    const auto begin = paths.begin() + i * chunk_size;
+    const auto end = paths.begin() + std::min(paths.size(), (i + 1) * chunk_size);
+    const Clipper2Lib::Paths64 chunk(std::make_move_iterator(begin), std::make_move_iterator(end));
+    parts[i] = process(chunk, Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero);
+  });
+
+  while (parts.size() > 1) {
+    std::vector<Clipper2Lib::Paths64> merged((parts.size() + 1) / 2);
+    parallelizable_for(size_t{0}, merged.size(), [&](size_t i) {
+      if (2 * i + 1 == parts.size()) {
+        merged[i] = std::move(parts[2 * i]);
+        return;
+      }
+      auto pair = std::move(parts[2 * i]);
+      std::move(parts[2 * i + 1].begin(), parts[2 * i + 1].end(), std::back_inserter(pair));
+      merged[i] = process(pair, Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero);
+    });
+    parts = std::move(merged);
+  }
+  return std::move(parts.front());
+}
+
 void SimplifyPolyTree(const Clipper2Lib::PolyPath64& polytree, double epsilon, Clipper2Lib::PolyPath64& result) {
   for (const auto& child : polytree) {
     Clipper2Lib::PolyPath64 *newchild = result.AddChild(Clipper2Lib::SimplifyPath(child->Polygon(), epsilon));
@@ -295,6 +360,29 @@ std::unique_ptr<Polygon2d> applyMinkowski(const std::vector<std::shared_ptr<cons
   if (it == polygons.end()) return nullptr;
   const int scale_bits = scaleBitsFromPrecision();
 
+  // Minkowski with a circle() is a round offset followed by a translation to
+  // the circle's center. Using the same arc tolerance as offset() for the
+  // circle's fragment count keeps the rounding resolution.
+  // Regular polygons with few sides, like a square or a hexagon, are shapes
+  // of their own rather than circles, so they are convolved exactly.
+  constexpr size_t min_circle_fragments = 16;
+  if (Feature::ExperimentalMinkowskiOffset.is_enabled() && polygons.size() == 2 && polygons[0] && polygons[1]) {
+    Vector2d center;
+    double r;
+    for (size_t i : {0, 1}) {
+      if (getRegularPolygon(*polygons[i], center, r) &&
+          polygons[i]->outlines()[0].vertices.size() >= min_circle_fragments) {
+        const size_t n = polygons[i]->outlines()[0].vertices.size();
+        const double arc_tolerance = r * (1 - std::cos(M_PI / n));
+        const auto& other = polygons[1 - i];
+        auto result = applyOffset(other->isSanitized() ? *other : *sanitize(*other),
+                                  r, Clipper2Lib::JoinType::Round, 2.0, arc_tolerance);
+        result->transform(Transform2d(Eigen::Translation2d(center)));
+        return result;
+      }
+    }
+  }
+
   Clipper2Lib::Clipper64 clipper;
   clipper.PreserveCollinear(false);
   auto lhs = fromPolygon2d(polygons[0] ? *polygons[0] : Polygon2d(), scale_bits);
@@ -304,13 +392,21 @@ std::unique_ptr<Polygon2d> applyMinkowski(const std::vector<std::shared_ptr<cons
     Clipper2Lib::Paths64 minkowski_terms;
     auto rhs = fromPolygon2d(*polygons[i], scale_bits);
 
-    // First, convolve each outline of lhs with the outlines of rhs
-    for (auto const& rhs_path : rhs) {
-      for (auto const& lhs_path : lhs) {
-        Clipper2Lib::Paths64 result;
-        minkowski_outline(lhs_path, rhs_path, result, true, true);
-        minkowski_terms.insert(minkowski_terms.end(), result.begin(), result.end());
-      }
+    // First, convolve each outline of lhs with the outlines of rhs.
+    // The pairs are independent, so convolve them in parallel and concatenate
+    // in pair order to keep the result deterministic.
+    std::vector<Clipper2Lib::Paths64> pair_terms(rhs.size() * lhs.size());
+    parallelizable_cross_product_transform(rhs, lhs, pair_terms.begin(),
+      [](const Clipper2Lib::Path64& rhs_path, const Clipper2Lib::Path64& lhs_path) {
+      Clipper2Lib::Paths64 result;
+      minkowski_outline(lhs_path, rhs_path, result, true, true);
+      return result;
+    });
+    size_t num_terms = 0;
+    for (const auto& terms : pair_terms) num_terms += terms.size();
+    minkowski_terms.reserve(num_terms);
+    for (auto& terms : pair_terms) {
+      std::move(terms.begin(), terms.end(), std::back_inserter(minkowski_terms));
     }
 
     // Then, fill the central parts
@@ -356,10 +452,9 @@ std::unique_ptr<Polygon2d> applyProjection(const std::vector<std::shared_ptr<con
   Clipper2Lib::Clipper64 sumclipper;
   sumclipper.PreserveCollinear(false);
   for (const auto &poly : polygons) {
-    Clipper2Lib::Paths64 result = ClipperUtils::fromPolygon2d(*poly, scale_bits);
     // Using NonZero ensures that we don't create holes from polygons sharing
     // edges since we're unioning a mesh
-    result = ClipperUtils::process(result, Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero);
+    auto result = parallelUnion(ClipperUtils::fromPolygon2d(*poly, scale_bits));
     // Add correctly winded polygons to the main clipper
     sumclipper.AddSubject(result);
   }
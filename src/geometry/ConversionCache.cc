@@ -0,0 +1,123 @@
+#include "geometry/ConversionCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "geometry/GeometryCache.h"
+#ifdef ENABLE_CGAL
+#include "geometry/cgal/CGALCache.h"
+#endif
+#include "utils/printutils.h"
+
+ConversionCache *ConversionCache::inst = nullptr;
+
+bool ConversionCache::isCached(const std::shared_ptr<const Geometry>& source)
+{
+  return GeometryCache::instance()->holds(source.get())
+#ifdef ENABLE_CGAL
+         || CGALCache::instance()->holds(source.get())
+#endif
+  ;
+}
+
+std::string ConversionCache::makeKey(const std::shared_ptr<const Geometry>& source, const std::string& target)
+{
+  return target + ':' + std::to_string(reinterpret_cast<uintptr_t>(source.get()));
+}
+
+std::shared_ptr<const void> ConversionCache::lookup(const std::string& key, const std::shared_ptr<const Geometry>& source)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (const auto *entry = this->cache[key]) {
+    if (entry->source.lock() == source) {
+      this->num_hits++;
+      return entry->data;
+    }
+    // The source this was converted from is gone
+    this->cache.remove(key);
+  }
+  return nullptr;
+}
+
+void ConversionCache::store(const std::string& key, const std::shared_ptr<const Geometry>& source,
+                            const std::shared_ptr<const void>& data, size_t cost,
+                            std::chrono::steady_clock::duration elapsed)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->num_conversions++;
+  this->conversion_time += elapsed;
+  if (data) {
+    // Drop the conversions of freed sources now and then, instead of waiting for them to be trimmed
+    if (this->cache.size() >= this->prune_size) {
+      this->cache.removeIf([](const cache_entry& entry) { return entry.source.expired(); });
+      this->prune_size = std::max<size_t>(64, this->cache.size() * 2);
+    }
+    this->cache.insert(key, new cache_entry{source, data}, cost);
+  }
+}
+
+std::shared_ptr<const Geometry> ConversionCache::get(const std::shared_ptr<const Geometry>& source,
+                                                     const std::string& target, const Converter& convert)
+{
+  if (!source || !isCached(source)) return convert();
+
+  const auto key = makeKey(source, target);
+  if (auto data = lookup(key, source)) return std::static_pointer_cast<const Geometry>(data);
+
+  // The lock isn't held while converting; conversions may be nested
+  const auto start = std::chrono::steady_clock::now();
+  auto converted = convert();
+  store(key, source, converted, converted ? converted->memsize() : 0, std::chrono::steady_clock::now() - start);
+  return converted;
+}
+
+size_t ConversionCache::size() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return cache.size();
+}
+
+size_t ConversionCache::totalCost() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return cache.totalCost();
+}
+
+size_t ConversionCache::maxSizeMB() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->cache.maxCost() / (1024ul * 1024ul);
+}
+
+void ConversionCache::setMaxSizeMB(size_t limit)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->cache.setMaxCost(limit * 1024ul * 1024ul);
+}
+
+void ConversionCache::clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  cache.clear();
+  this->num_conversions = 0;
+  this->num_hits = 0;
+  this->conversion_time = {};
+}
+
+std::chrono::milliseconds ConversionCache::conversionTime() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return std::chrono::duration_cast<std::chrono::milliseconds>(this->conversion_time);
+}
+
+void ConversionCache::print()
+{
+  LOG("Backend conversions: %1$d (%2$d reused), %3$d ms", conversions(), hits(), conversionTime().count());
+  LOG("Conversions in cache: %1$d", size());
+  LOG("Conversion cache size in bytes: %1$d", totalCost());
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "Cache.h"
+#include "geometry/Geometry.h"
+
+/*!
+   Remembers backend-specific conversions (Nef polyhedra, Manifold) of
+   geometry objects, so that an object used as an operand of several
+   operations is only converted once. Other data derived from a geometry,
+   like the convex decomposition used by minkowski(), can be kept as well.
+
+   Entries are keyed by the identity of the source object, and only hold a
+   weak reference to it: an entry whose source has been freed is never
+   returned, even if another object is later allocated at the same address.
+   Like everything handed around as std::shared_ptr<const Geometry>, sources
+   must not be modified once they have been converted.
+
+   Only conversions of sources held by the GeometryCache or CGALCache are
+   kept; other sources are temporaries which can't be seen again.
+ */
+class ConversionCache
+{
+public:
+  ConversionCache(size_t limit = 100ul * 1024ul * 1024ul) : cache(limit) {}
+
+  static ConversionCache *instance() { if (!inst) inst = new ConversionCache; return inst; }
+
+  using Converter = std::function<std::shared_ptr<const Geometry>()>;
+  // Returns the cached conversion of source to target, or calls convert and caches its result
+  std::shared_ptr<const Geometry> get(const std::shared_ptr<const Geometry>& source,
+                                      const std::string& target, const Converter& convert);
+
+  // Like get(), for derived data which isn't a Geometry
+  template <class T>
+  std::shared_ptr<const T> getData(const std::shared_ptr<const Geometry>& source, const std::string& target,
+                                   const std::function<std::shared_ptr<const T>()>& compute,
+                                   const std::function<size_t(const T&)>& cost) {
+    if (!source || !isCached(source)) return compute();
+    const auto key = makeKey(source, target);
+    if (auto data = lookup(key, source)) return std::static_pointer_cast<const T>(data);
+    const auto start = std::chrono::steady_clock::now();
+    auto data = compute();
+    store(key, source, data, data ? cost(*data) : 0, std::chrono::steady_clock::now() - start);
+    return data;
+  }
+
+  size_t size() const;
+  size_t totalCost() const;
+  size_t maxSizeMB() const;
+  void setMaxSizeMB(size_t limit);
+  void clear();
+  void print();
+
+  size_t conversions() const { std::lock_guard<std::mutex> lock(this->mutex); return this->num_conversions; }
+  size_t hits() const { std::lock_guard<std::mutex> lock(this->mutex); return this->num_hits; }
+  std::chrono::milliseconds conversionTime() const;
+
+private:
+  static ConversionCache *inst;
+
+  static bool isCached(const std::shared_ptr<const Geometry>& source);
+  static std::string makeKey(const std::shared_ptr<const Geometry>& source, const std::string& target);
+  std::shared_ptr<const void> lookup(const std::string& key, const std::shared_ptr<const Geometry>& source);
+  void store(const std::string& key, const std::shared_ptr<const Geometry>& source,
+             const std::shared_ptr<const void>& data, size_t cost, std::chrono::steady_clock::duration elapsed);
+
+  struct cache_entry {
+    std::weak_ptr<const Geometry> source;
+    std::shared_ptr<const void> data;
+  };
+
+  Cache<std::string, cache_entry> cache;
+  size_t prune_size{64};
+  mutable std::mutex mutex;
+  size_t num_conversions{0};
+  size_t num_hits{0};
+  std::chrono::steady_clock::duration conversion_time{0};
+};
@@ -5,6 +5,7 @@
 #include <memory>
 #include <cstddef>
 #include <string>
+#include <unordered_set>
 
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/CGAL_Nef_polyhedron.h"
@@ -23,7 +24,7 @@ std::shared_ptr<const Geometry> GeometryCache::get(const std::string& id) const
 
 bool GeometryCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom)
 {
-  auto inserted = this->cache.insert(id, new cache_entry(geom), geom ? geom->memsize() : 0);
+  auto inserted = this->cache.insert(id, new cache_entry(geom, this->held), geom ? geom->memsize() : 0);
 #if defined(ENABLE_CGAL) && defined(DEBUG)
   assert(!dynamic_cast<const CGAL_Nef_polyhedron *>(geom.get()));
   if (inserted) PRINTDB("Geometry Cache insert: %s (%d bytes)",
@@ -60,8 +61,16 @@ void GeometryCache::print()
   LOG("Geometry cache size in bytes: %1$d", this->cache.totalCost());
 }
 
-GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& geom)
-  : geom(geom)
+GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& geom,
+                                        std::unordered_multiset<const Geometry *>& held)
+  : geom(geom), held(held)
 {
   if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
+  if (geom) held.insert(geom.get());
+}
+
+GeometryCache::cache_entry::~cache_entry()
+{
+  const auto it = held.find(geom.get());
+  if (it != held.end()) held.erase(it);
 }
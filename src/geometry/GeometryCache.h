@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <unordered_set>
 
 #include "Cache.h"
 #include "geometry/Geometry.h"
@@ -17,6 +18,8 @@ public:
   bool contains(const std::string& id) const { return this->cache.contains(id); }
   std::shared_ptr<const class Geometry> get(const std::string& id) const;
   bool insert(const std::string& id, const std::shared_ptr<const Geometry>& geom);
+  // Whether geom is held by one of the cache entries
+  bool holds(const Geometry *geom) const { return this->held.count(geom) > 0; }
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
@@ -30,8 +33,12 @@ private:
   struct cache_entry {
     std::shared_ptr<const class Geometry> geom;
     std::string msg;
-    cache_entry(const std::shared_ptr<const Geometry>& geom);
+    std::unordered_multiset<const Geometry *>& held;
+    cache_entry(const std::shared_ptr<const Geometry>& geom, std::unordered_multiset<const Geometry *>& held);
+    ~cache_entry();
   };
 
+  // Declared before the cache, as its entries remove themselves from it
+  std::unordered_multiset<const Geometry *> held;
   Cache<std::string, cache_entry> cache;
 };
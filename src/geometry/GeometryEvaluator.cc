@@ -1,6 +1,7 @@
 #include "geometry/GeometryEvaluator.h"
 #include "core/Tree.h"
 #include "geometry/GeometryCache.h"
+#include "geometry/Operation2DCache.h"
 #include "geometry/Polygon2d.h"
 #include "core/ModuleInstantiation.h"
 #include "core/State.h"
@@ -18,6 +19,7 @@
 #include "core/TextNode.h"
 #include "core/RenderNode.h"
 #include "geometry/ClipperUtils.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/PolySetUtils.h"
 #include "geometry/PolySet.h"
 #include "geometry/PolySetBuilder.h"
@@ -27,7 +29,11 @@
 #include "io/DxfData.h"
 #include "glview/RenderSettings.h"
 #include "utils/degree_trig.h"
+#include "utils/hash.h"
+#include "utils/parallel.h"
 #include <cmath>
+#include <sstream>
+#include <string>
 #include <iterator>
 #include <cassert>
 #include <list>
@@ -48,6 +54,7 @@
 #include "geometry/linear_extrude.h"
 
 #include <cstddef>
+#include <unordered_map>
 #include <vector>
 
 class Geometry;
@@ -79,6 +86,9 @@ std::shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const Abstra
     smartCacheInsert(node, result);
   }
 
+  // Instances only share their mesh while evaluating; callers get the transformed geometry
+  result = InstancedGeometry::resolve(result);
+
   // Convert engine-specific 3D geometry to PolySet if needed
   // Note: we don't store the converted into the cache as it would conflict with subsequent calls where allownef is true.
   if (!allownef) {
@@ -589,12 +599,18 @@ Response GeometryEvaluator::visit(State& state, const OffsetNode& node)
   if (state.isPostfix()) {
     std::shared_ptr<const Geometry> geom;
     if (!isSmartCached(node)) {
-      if (const auto polygon = applyToChildren2D(node, OpenSCADOperator::UNION)) {
+      if (const std::shared_ptr<const Polygon2d> polygon = applyToChildren2D(node, OpenSCADOperator::UNION)) {
         // ClipperLib documentation: The formula for the number of steps in a full
         // circular arc is ... Pi / acos(1 - arc_tolerance / abs(delta))
         double n = Calc::get_fragments_from_r(std::abs(node.delta), node.fn, node.fs, node.fa);
         double arc_tolerance = std::abs(node.delta) * (1 - cos_degrees(180 / n));
-        geom = ClipperUtils::applyOffset(*polygon, node.delta, node.join_type, node.miter_limit, arc_tolerance);
+        std::ostringstream key;
+        key << "offset:" << polygon->fingerprint() << std::hexfloat
+            << ':' << node.delta << ':' << static_cast<int>(node.join_type)
+            << ':' << node.miter_limit << ':' << arc_tolerance;
+        geom = Operation2DCache::instance()->get(key.str(), {polygon}, [&]() -> std::shared_ptr<const Geometry> {
+          return ClipperUtils::applyOffset(*polygon, node.delta, node.join_type, node.miter_limit, arc_tolerance);
+        });
         assert(geom);
       }
     } else {
@@ -740,9 +756,15 @@ Response GeometryEvaluator::visit(State& state, const TransformNode& node)
               geom = ClipperUtils::sanitize(*polygons);
             }
           } else if (geom->getDimension() == 3) {
-            auto mutableGeom = res.asMutableGeometry();
-            if (mutableGeom) mutableGeom->transform(node.matrix);
-            geom = mutableGeom;
+            if (res.isConst() && InstancedGeometry::canInstance(*geom)) {
+              // Don't copy a mesh which is shared with the cache or a sibling,
+              // just record where it is placed
+              geom = std::make_shared<InstancedGeometry>(geom, node.matrix);
+            } else {
+              auto mutableGeom = res.asMutableGeometry();
+              if (mutableGeom) mutableGeom->transform(node.matrix);
+              geom = mutableGeom;
+            }
           }
         }
       }
@@ -783,49 +805,28 @@ Response GeometryEvaluator::visit(State& state, const LinearExtrudeNode& node)
   return Response::ContinueTraversal;
 }
 
-static void fill_ring(std::vector<Vector3d>& ring, const Outline2d& o, double a, bool flip)
-{
-  if (flip) {
-    unsigned int l = o.vertices.size() - 1;
-    for (unsigned int i = 0; i < o.vertices.size(); ++i) {
-      ring[i][0] = o.vertices[l - i][0] * cos_degrees(a);
-      ring[i][1] = o.vertices[l - i][0] * sin_degrees(a);
-      ring[i][2] = o.vertices[l - i][1];
-    }
-  } else {
-    for (unsigned int i = 0; i < o.vertices.size(); ++i) {
-      ring[i][0] = o.vertices[i][0] * cos_degrees(a);
-      ring[i][1] = o.vertices[i][0] * sin_degrees(a);
-      ring[i][2] = o.vertices[i][1];
-    }
-  }
-}
-
 /*!
    Input to extrude should be clean. This means non-intersecting, correct winding order
    etc., the input coming from a library like Clipper.
 
+   The mesh is a regular grid of rings, so vertices and triangles are generated directly
+   using index arithmetic, in parallel over the angular fragments:
+   o Vertices on the Y axis collapse to a single vertex shared by all rings, and the
+     resulting zero-area triangles are dropped.
+   o Coincident outline vertices (e.g. touching outlines) share their vertices.
+   o For a full revolution, the last ring is the first ring.
+
    FIXME: We should handle some common corner cases better:
    o 2D polygon having an edge being on the Y axis:
     In this case, we don't need to generate geometry involving this edge as it
     will be an internal edge.
    o 2D polygon having a vertex touching the Y axis:
-    This is more complex as the resulting geometry will (may?) be nonmanifold.
-    In any case, the previous case is a specialization of this, so the following
-    should be handled for both cases:
-    Since the ring associated with this vertex will have a radius of zero, it will
-    collapse to one vertex. Any quad using this ring will be collapsed to a triangle.
-
-   Currently, we generate a lot of zero-area triangles
-
+    The resulting geometry will (may?) be nonmanifold.
  */
-static std::unique_ptr<Geometry> rotatePolygon(const RotateExtrudeNode& node, const Polygon2d& poly)
+static std::shared_ptr<const Geometry> rotatePolygon(const RotateExtrudeNode& node, const Polygon2d& poly)
 {
   if (node.angle == 0) return nullptr;
 
-  PolySetBuilder builder;
-  builder.setConvexity(node.convexity);
-
   double min_x = 0;
   double max_x = 0;
   unsigned int fragments = 0;
@@ -844,59 +845,129 @@ static std::unique_ptr<Geometry> rotatePolygon(const RotateExtrudeNode& node, co
   fragments = (unsigned int)std::ceil(fmax(Calc::get_fragments_from_r(max_x - min_x, node.fn, node.fs, node.fa) * std::abs(node.angle) / 360, 1));
 
   bool flip_faces = (min_x >= 0 && node.angle > 0) || (min_x < 0 && node.angle < 0);
+  const bool closed = node.angle == 360;
+  const size_t num_rings = closed ? fragments : fragments + 1;
+
+  // Outline vertices in ring order (reversed per outline when flipping faces),
+  // and the slot each of them occupies: axis vertices are stored once in front
+  // of the rings, all other vertices once per ring.
+  std::vector<Vector2d> profile;
+  std::vector<std::pair<size_t, size_t>> outline_ranges;
+  for (const auto& o : poly.outlines()) {
+    outline_ranges.emplace_back(profile.size(), o.vertices.size());
+    if (flip_faces) profile.insert(profile.end(), o.vertices.rbegin(), o.vertices.rend());
+    else profile.insert(profile.end(), o.vertices.begin(), o.vertices.end());
+  }
 
-  // If not going all the way around, we have to create faces on each end.
-  if (node.angle != 360) {
-    auto ps_start = poly.tessellate(); // starting face
-    Transform3d rotx(angle_axis_degrees(90, Vector3d::UnitX()));
-    Transform3d rotz1(angle_axis_degrees(node.start, Vector3d::UnitZ()));
-    ps_start->transform(rotz1 * rotx);
-    // Flip vertex ordering
-    if (!flip_faces) {
-      for (auto& p : ps_start->indices) {
-        std::reverse(p.begin(), p.end());
+  std::unordered_map<Vector3d, int> profile_slot; // keyed by (x, y, 0)
+  std::vector<int> slots(profile.size());
+  std::vector<size_t> ring_profile; // profile index of each ring slot
+  std::vector<size_t> axis_profile; // profile index of each axis slot
+  for (size_t k = 0; k < profile.size(); ++k) {
+    const auto& v = profile[k];
+    auto [it, inserted] = profile_slot.emplace(Vector3d(v[0], v[1], 0.0), 0);
+    if (inserted) {
+      if (v[0] == 0) {
+        it->second = -1 - static_cast<int>(axis_profile.size());
+        axis_profile.push_back(k);
+      } else {
+        it->second = static_cast<int>(ring_profile.size());
+        ring_profile.push_back(k);
       }
     }
-    builder.appendPolySet(*ps_start);
-
-    auto ps_end = poly.tessellate();
-    Transform3d rotz2(angle_axis_degrees(node.start + node.angle, Vector3d::UnitZ()));
-    ps_end->transform(rotz2 * rotx);
-    if (flip_faces) {
-      for (auto& p : ps_end->indices) {
-        std::reverse(p.begin(), p.end());
+    slots[k] = it->second;
+  }
+  const size_t num_axis = axis_profile.size();
+  const size_t ring_size = ring_profile.size();
+  auto vertex_index = [&](int slot, size_t ring) -> int {
+    if (slot < 0) return -1 - slot;
+    return num_axis + (ring % num_rings) * ring_size + slot;
+  };
+  auto ring_angle = [&](size_t ring) {
+    return ring == 0 ? node.start : node.start + ring * node.angle / fragments; // start on the X axis
+  };
+
+  std::vector<Vector3d> vertices(num_axis + num_rings * ring_size);
+  for (size_t i = 0; i < num_axis; ++i) {
+    const auto& v = profile[axis_profile[i]];
+    vertices[i] = Vector3d(v[0] * cos_degrees(node.start), v[0] * sin_degrees(node.start), v[1]);
+  }
+  parallelizable_for(0, num_rings, [&](size_t ring) {
+    const double a = ring_angle(ring);
+    const double c = cos_degrees(a);
+    const double s = sin_degrees(a);
+    auto out = vertices.begin() + num_axis + ring * ring_size;
+    for (size_t k : ring_profile) {
+      const auto& v = profile[k];
+      *out++ = Vector3d(v[0] * c, v[0] * s, v[1]);
+    }
+  });
+
+  // Two triangles per outline vertex and fragment. Triangles touching the axis
+  // degenerate; they're marked empty and removed afterwards.
+  PolygonIndices indices(fragments * profile.size() * 2);
+  parallelizable_for(0, fragments, [&](size_t j) {
+    auto out = indices.begin() + j * profile.size() * 2;
+    auto add_triangle = [&](int a, int b, int c) {
+      if (a != b && b != c && c != a) *out = {a, b, c};
+      ++out;
+    };
+    for (const auto& [start, size] : outline_ranges) {
+      for (size_t i = 0; i < size; ++i) {
+        const int curr = slots[start + i];
+        const int next = slots[start + (i + 1) % size];
+        add_triangle(vertex_index(next, j), vertex_index(next, j + 1), vertex_index(curr, j));
+        add_triangle(vertex_index(next, j + 1), vertex_index(curr, j + 1), vertex_index(curr, j));
       }
     }
-    builder.appendPolySet(*ps_end);
-  }
+  });
+  indices.erase(std::remove_if(indices.begin(), indices.end(), [](const IndexedFace& f) { return f.empty(); }),
+                indices.end());
 
-  for (const auto& o : poly.outlines()) {
-    std::vector<Vector3d> rings[2];
-    rings[0].resize(o.vertices.size());
-    rings[1].resize(o.vertices.size());
-
-    fill_ring(rings[0], o, node.start, flip_faces); // first ring
-    for (unsigned int j = 0; j < fragments; ++j) {
-      double a = node.start + (j + 1) * node.angle / fragments; // start on the X axis
-      fill_ring(rings[(j + 1) % 2], o, a, flip_faces);
-
-      for (size_t i = 0; i < o.vertices.size(); ++i) {
-        builder.appendPolygon({
-                rings[j % 2][(i + 1) % o.vertices.size()],
-                rings[(j + 1) % 2][(i + 1) % o.vertices.size()],
-                rings[j % 2][i]
-        });
-
-        builder.appendPolygon({
-                rings[(j + 1) % 2][(i + 1) % o.vertices.size()],
-                rings[(j + 1) % 2][i],
-                rings[j % 2][i]
-        });
+  // If not going all the way around, we have to create faces on each end.
+  if (!closed) {
+    auto ps_cap = poly.tessellate();
+    Transform3d rotx(angle_axis_degrees(90, Vector3d::UnitX()));
+    auto add_cap = [&](size_t ring, bool reverse) {
+      // Vertices introduced by the tessellator aren't part of any ring
+      std::unordered_map<int, int> extra_vertices;
+      Transform3d rotz(angle_axis_degrees(ring_angle(ring), Vector3d::UnitZ()));
+      for (const auto& p : ps_cap->indices) {
+        IndexedFace face;
+        for (const auto idx : p) {
+          const auto& v = ps_cap->vertices[idx];
+          auto it = profile_slot.find(Vector3d(v[0], v[1], 0.0));
+          if (it != profile_slot.end()) {
+            face.push_back(vertex_index(it->second, ring));
+          } else {
+            auto [extra, inserted] = extra_vertices.emplace(idx, vertices.size());
+            if (inserted) vertices.push_back(rotz * rotx * v);
+            face.push_back(extra->second);
+          }
+        }
+        if (reverse) std::reverse(face.begin(), face.end());
+        indices.push_back(std::move(face));
       }
+    };
+    add_cap(0, !flip_faces);
+    add_cap(fragments, flip_faces);
+  }
+
+#ifdef ENABLE_MANIFOLD
+  if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
+    if (auto mani = ManifoldUtils::createManifoldFromTriangles(vertices, indices)) {
+      mani->setConvexity(node.convexity);
+      return mani;
     }
   }
+#endif
 
-  return builder.build();
+  auto ps = std::make_shared<PolySet>(3);
+  ps->setConvexity(node.convexity);
+  ps->setTriangular(true);
+  ps->vertices = std::move(vertices);
+  ps->indices = std::move(indices);
+  return ps;
 }
 
 /*!
@@ -993,8 +1064,12 @@ std::shared_ptr<const Geometry> GeometryEvaluator::projectionNoCut(const Project
       }
     }
   }
-  auto projected = ClipperUtils::applyProjection(tmp_geom);
-  return std::shared_ptr(std::move(projected));
+  std::ostringstream key;
+  key << "projection";
+  for (const auto& poly : tmp_geom) key << ':' << poly->fingerprint();
+  return Operation2DCache::instance()->get(key.str(), tmp_geom, [&]() -> std::shared_ptr<const Geometry> {
+    return ClipperUtils::applyProjection(tmp_geom);
+  });
 }
 
 
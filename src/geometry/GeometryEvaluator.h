@@ -3,6 +3,7 @@
 #include "core/NodeVisitor.h"
 #include "core/enums.h"
 #include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
 
 #include <cassert>
 #include <memory>
@@ -67,8 +68,16 @@ public:
     [[nodiscard]] std::shared_ptr<const Geometry> constptr() const {
       return is_const ? const_pointer : std::static_pointer_cast<const Geometry>(pointer);
     }
+    [[nodiscard]] bool isConst() const { return is_const; }
     std::shared_ptr<Geometry> asMutableGeometry() {
-      if (is_const) return {constptr() ? constptr()->copy() : nullptr};
+      if (is_const) {
+        if (!constptr()) return nullptr;
+        // Instances are handed out as the concrete, transformed geometry
+        if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(constptr())) {
+          return instance->materialize();
+        }
+        return constptr()->copy();
+      }
       else return ptr();
     }
 private:
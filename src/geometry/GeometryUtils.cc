@@ -18,6 +18,7 @@
 #include "glview/RenderSettings.h"
 #include "Feature.h"
 #include "geometry/PolySet.h"
+#include "geometry/InstancedGeometry.h"
 
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/cgalutils.h"
@@ -520,6 +521,9 @@ Transform3d GeometryUtils::getResizeTransform(const BoundingBox &bbox, const Vec
 // geom must be a 3D PolySet or the correct backend-specific geometry.
 std::shared_ptr<const Geometry> GeometryUtils::getBackendSpecificGeometry(const std::shared_ptr<const Geometry>& geom)
 {
+  if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return getBackendSpecificGeometry(instance->materialize());
+  }
 #if ENABLE_MANIFOLD
   if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
     if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
@@ -0,0 +1,96 @@
+#include "geometry/InstancedGeometry.h"
+
+#include "geometry/Geometry.h"
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+InstancedGeometry::InstancedGeometry(std::shared_ptr<const Geometry> geom, const Transform3d& matrix)
+{
+  if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    this->base = instance->base;
+    this->transforms = instance->transforms;
+    this->convexity = instance->convexity;
+  } else {
+    this->base = std::move(geom);
+    this->convexity = this->base->getConvexity();
+  }
+  this->transforms.push_back(matrix);
+}
+
+size_t InstancedGeometry::memsize() const
+{
+  // The base geometry is shared, and accounted for by whoever created it
+  return sizeof(InstancedGeometry) + this->transforms.capacity() * sizeof(Transform3d);
+}
+
+BoundingBox InstancedGeometry::getBoundingBox() const
+{
+  if (bbox_.isNull()) {
+    if (const auto *ps = dynamic_cast<const PolySet *>(this->base.get())) {
+      for (const auto& v : ps->vertices) {
+        bbox_.extend(transformed(v));
+      }
+    } else {
+      bbox_ = materialize()->getBoundingBox();
+    }
+  }
+  return bbox_;
+}
+
+std::string InstancedGeometry::dump() const
+{
+  return materialize()->dump();
+}
+
+std::unique_ptr<Geometry> InstancedGeometry::copy() const
+{
+  return std::make_unique<InstancedGeometry>(*this);
+}
+
+void InstancedGeometry::transform(const Transform3d& mat)
+{
+  this->transforms.push_back(mat);
+  bbox_.setNull();
+}
+
+void InstancedGeometry::accept(GeometryVisitor& visitor) const
+{
+  materialize()->accept(visitor);
+}
+
+Vector3d InstancedGeometry::transformed(const Vector3d& v) const
+{
+  Vector3d p = v;
+  for (const auto& mat : this->transforms) p = mat * p;
+  return p;
+}
+
+std::unique_ptr<Geometry> InstancedGeometry::materialize() const
+{
+  auto geom = this->base->copy();
+  for (const auto& mat : this->transforms) geom->transform(mat);
+  geom->setConvexity(this->convexity);
+  return geom;
+}
+
+bool InstancedGeometry::canInstance(const Geometry& geom)
+{
+  if (dynamic_cast<const InstancedGeometry *>(&geom)) return true;
+  // Other 3D geometry types either share their data on copy already, or
+  // have to be converted for every operation anyway.
+  const auto *ps = dynamic_cast<const PolySet *>(&geom);
+  return ps && ps->getDimension() == 3;
+}
+
+std::shared_ptr<const Geometry> InstancedGeometry::resolve(const std::shared_ptr<const Geometry>& geom)
+{
+  if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return instance->materialize();
+  }
+  return geom;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "geometry/Geometry.h"
+#include "geometry/linalg.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*!
+   A placement of an immutable 3D geometry.
+
+   Transforming a cached PolySet used to require a deep copy of the mesh, so
+   placing the same part many times kept a transformed copy of it for every
+   placement. An InstancedGeometry instead shares the mesh with all other
+   placements and only records the transforms. They are applied, in order,
+   by materialize() once an operation needs the actual vertices.
+ */
+class InstancedGeometry : public Geometry
+{
+public:
+  InstancedGeometry(std::shared_ptr<const Geometry> geom, const Transform3d& matrix);
+
+  [[nodiscard]] size_t memsize() const override;
+  [[nodiscard]] BoundingBox getBoundingBox() const override;
+  [[nodiscard]] std::string dump() const override;
+  [[nodiscard]] unsigned int getDimension() const override { return base->getDimension(); }
+  [[nodiscard]] bool isEmpty() const override { return base->isEmpty(); }
+  [[nodiscard]] std::unique_ptr<Geometry> copy() const override;
+  [[nodiscard]] size_t numFacets() const override { return base->numFacets(); }
+  void transform(const Transform3d& mat) override;
+  void accept(GeometryVisitor& visitor) const override;
+
+  [[nodiscard]] const std::shared_ptr<const Geometry>& getBase() const { return base; }
+  // Places a point of the base geometry the same way materialize() does
+  [[nodiscard]] Vector3d transformed(const Vector3d& v) const;
+  [[nodiscard]] std::unique_ptr<Geometry> materialize() const;
+
+  // Whether placing geom is cheaper as an instance than as a transformed copy
+  static bool canInstance(const Geometry& geom);
+  // Returns the materialized geometry if geom is an instance, otherwise geom itself
+  static std::shared_ptr<const Geometry> resolve(const std::shared_ptr<const Geometry>& geom);
+
+private:
+  std::shared_ptr<const Geometry> base;
+  // Applied one after the other, rather than as a single product, so the
+  // vertices come out exactly as if each transform had been applied eagerly.
+  std::vector<Transform3d> transforms;
+  mutable BoundingBox bbox_;
+};
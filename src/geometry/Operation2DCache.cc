@@ -0,0 +1,64 @@
+#include "geometry/Operation2DCache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "geometry/Geometry.h"
+#include "geometry/Polygon2d.h"
+#include "utils/printutils.h"
+
+Operation2DCache *Operation2DCache::inst = nullptr;
+
+static bool sameOutlines(const Polygon2d& a, const Polygon2d& b)
+{
+  if (a.isSanitized() != b.isSanitized() || a.outlines().size() != b.outlines().size()) return false;
+  for (size_t i = 0; i < a.outlines().size(); ++i) {
+    const auto& oa = a.outlines()[i];
+    const auto& ob = b.outlines()[i];
+    if (oa.positive != ob.positive || oa.vertices != ob.vertices) return false;
+  }
+  return true;
+}
+
+std::shared_ptr<const Geometry> Operation2DCache::lookup(const std::string& key, const Inputs& inputs)
+{
+  if (const auto *entry = this->cache[key]) {
+    auto result = entry->result.lock();
+    if (result && entry->inputs.size() == inputs.size() &&
+        std::equal(inputs.begin(), inputs.end(), entry->inputs.begin(),
+                   [](const auto& a, const auto& b) { return sameOutlines(*a, *b); })) {
+      return result;
+    }
+  }
+  return nullptr;
+}
+
+void Operation2DCache::insert(const std::string& key, const Inputs& inputs, const std::shared_ptr<const Geometry>& result)
+{
+  // Drop the entries of freed results now and then, instead of waiting for them to be trimmed
+  if (this->cache.size() >= this->prune_size) {
+    this->cache.removeIf([](const cache_entry& entry) { return entry.result.expired(); });
+    this->prune_size = std::max<size_t>(64, this->cache.size() * 2);
+  }
+  size_t cost = 0;
+  for (const auto& poly : inputs) cost += poly->memsize();
+  this->cache.insert(key, new cache_entry{inputs, result}, cost);
+}
+
+size_t Operation2DCache::maxSizeMB() const
+{
+  return this->cache.maxCost() / (1024ul * 1024ul);
+}
+
+void Operation2DCache::setMaxSizeMB(size_t limit)
+{
+  this->cache.setMaxCost(limit * 1024ul * 1024ul);
+}
+
+void Operation2DCache::print()
+{
+  LOG("2D operations in cache: %1$d", this->cache.size());
+  LOG("2D operation cache size in bytes: %1$d", this->cache.totalCost());
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Cache.h"
+#include "geometry/Geometry.h"
+#include "geometry/Polygon2d.h"
+
+/*!
+   Caches 2D operations (offset, projection) by the content of their input
+   polygons and their parameters, so the same operation on the same input is
+   computed once even when it appears under different nodes.
+
+   Keys only hold a fingerprint of the inputs, so entries keep the inputs
+   themselves and a hit is only used if they are equal. The kept inputs are
+   what the cache is bounded by. Results are held weakly: they are the
+   results of the nodes which computed them as well, and are kept, and
+   accounted for, by those nodes' GeometryCache entries.
+ */
+class Operation2DCache
+{
+public:
+  Operation2DCache(size_t limit = 16ul * 1024ul * 1024ul) : cache(limit) {}
+
+  static Operation2DCache *instance() { if (!inst) inst = new Operation2DCache; return inst; }
+
+  using Inputs = std::vector<std::shared_ptr<const Polygon2d>>;
+
+  template <typename Compute>
+  std::shared_ptr<const Geometry> get(const std::string& key, const Inputs& inputs, const Compute& compute) {
+    if (auto result = lookup(key, inputs)) return result;
+    std::shared_ptr<const Geometry> result = compute();
+    if (result) insert(key, inputs, result);
+    return result;
+  }
+
+  size_t size() const { return this->cache.size(); }
+  size_t totalCost() const { return this->cache.totalCost(); }
+  size_t maxSizeMB() const;
+  void setMaxSizeMB(size_t limit);
+  void clear() { this->cache.clear(); }
+  void print();
+
+private:
+  static Operation2DCache *inst;
+
+  std::shared_ptr<const Geometry> lookup(const std::string& key, const Inputs& inputs);
+  void insert(const std::string& key, const Inputs& inputs, const std::shared_ptr<const Geometry>& result);
+
+  struct cache_entry {
+    Inputs inputs;
+    std::weak_ptr<const Geometry> result;
+  };
+
+  Cache<std::string, cache_entry> cache;
+  size_t prune_size{64};
+};
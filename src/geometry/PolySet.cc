@@ -90,10 +90,16 @@ BoundingBox PolySet::getBoundingBox() const
 
 size_t PolySet::memsize() const
 {
-  size_t mem = 0;
-  for (const auto& p : this->indices) mem += p.size() * sizeof(int);
-  for (const auto& p : this->vertices) mem += p.size() * sizeof(Vector3d);
-  mem += sizeof(PolySet);
+  // Count what is actually allocated: faces up to IndexedFace's inline
+  // capacity live inside the indices buffer, only larger ones spill to the heap.
+  size_t mem = sizeof(PolySet);
+  mem += this->indices.capacity() * sizeof(IndexedFace);
+  for (const auto& p : this->indices) {
+    if (p.capacity() > IndexedFace::static_capacity) mem += p.capacity() * sizeof(int);
+  }
+  mem += this->vertices.capacity() * sizeof(Vector3d);
+  mem += this->color_indices.capacity() * sizeof(int32_t);
+  mem += this->colors.capacity() * sizeof(Color4f);
   return mem;
 }
 void PolySet::transform(const Transform3d& mat)
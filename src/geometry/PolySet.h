@@ -42,6 +42,7 @@ public:
 
   bool isConvex() const;
   boost::tribool convexValue() const { return convex_; }
+  void setConvexValue(boost::tribool convex) { convex_ = convex; }
 
   bool isTriangular() const { return is_triangular_; }
   void setTriangular(bool triangular) { is_triangular_ = triangular; }
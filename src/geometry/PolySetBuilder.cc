@@ -27,6 +27,7 @@
 #include "geometry/PolySetBuilder.h"
 #include "geometry/PolySet.h"
 #include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
 
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/cgalutils.h"
@@ -94,6 +95,8 @@ void PolySetBuilder::appendGeometry(const std::shared_ptr<const Geometry>& geom)
     }
   } else if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     appendPolySet(*ps);
+  } else if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    appendGeometry(instance->materialize());
 #ifdef ENABLE_CGAL
   } else if (const auto N = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
     if (const auto ps = CGALUtils::createPolySetFromNefPolyhedron3(*(N->p3))) {
@@ -124,8 +127,10 @@ void PolySetBuilder::appendPolygon(const std::vector<int>& inds)
 
 void PolySetBuilder::appendPolygon(const std::vector<Vector3d>& polygon)
 {
+  polygon_indices_.resize(polygon.size());
+  vertices_.lookup(polygon.begin(), polygon.end(), polygon_indices_.begin());
   beginPolygon(polygon.size());
-  for (const auto& v: polygon) addVertex(v);
+  for (int idx : polygon_indices_) addVertex(idx);
   endPolygon();
 }
 
@@ -202,10 +207,14 @@ void PolySetBuilder::appendPolySet(const PolySet& ps)
   }
 
   reserve(numVertices() + ps.vertices.size(), numPolygons() + ps.indices.size());
+  // Vertices are shared by several faces, so look each one up only once.
+  // They're still added in order of first use, to keep the output stable.
+  polygon_indices_.assign(ps.vertices.size(), -1);
   for (const auto& poly : ps.indices) {
     beginPolygon(poly.size());
     for (const auto& ind: poly) {
-      addVertex(ps.vertices[ind]);
+      if (polygon_indices_[ind] < 0) polygon_indices_[ind] = vertexIndex(ps.vertices[ind]);
+      addVertex(polygon_indices_[ind]);
     }
     endPolygon();
   }
@@ -216,6 +225,7 @@ std::unique_ptr<PolySet> PolySetBuilder::build()
   endPolygon();
   std::unique_ptr<PolySet> polyset;
   polyset = std::make_unique<PolySet>(dim_, convex_);
+  polyset->vertices.reserve(vertices_.size());
   vertices_.copy(std::back_inserter(polyset->vertices));
   polyset->indices = std::move(indices_);
   polyset->color_indices = std::move(color_indices_);
@@ -48,4 +48,6 @@ private:
 
   // Will be initialized by beginPolygon() and cleared by endPolygon()
   IndexedFace current_polygon_;
+  // Scratch space for mapping input vertices to builder indices
+  std::vector<int> polygon_indices_;
 };
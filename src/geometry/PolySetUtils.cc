@@ -1,17 +1,21 @@
 #include "geometry/PolySetUtils.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <memory>
 #include <cstddef>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/range/adaptor/reversed.hpp>
 
 #include "geometry/PolySet.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/PolySetBuilder.h"
 #include "geometry/Polygon2d.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 #include "geometry/GeometryUtils.h"
 #ifdef ENABLE_CGAL
@@ -23,20 +27,61 @@
 
 namespace PolySetUtils {
 
-// Project all polygons (also back-facing) into a Polygon2d instance.
-// It is important to select all faces, since filtering by normal vector here
-// will trigger floating point incertainties and cause problems later.
+namespace {
+
+// True if every edge is shared by exactly one face in each direction,
+// i.e. the faces form closed, consistently oriented surfaces.
+bool isClosedSurface(const PolySet& ps)
+{
+  std::unordered_map<uint64_t, int> edges;
+  edges.reserve(ps.indices.size() * 2);
+  for (const auto& face : ps.indices) {
+    for (size_t i = 0; i < face.size(); ++i) {
+      const auto a = static_cast<uint32_t>(face[i]);
+      const auto b = static_cast<uint32_t>(face[(i + 1) % face.size()]);
+      if (a == b) continue;
+      const uint64_t key = a < b ? (uint64_t{a} << 32 | b) : (uint64_t{b} << 32 | a);
+      edges[key] += a < b ? 1 : -1;
+    }
+  }
+  return std::all_of(edges.begin(), edges.end(), [](const auto& edge) { return edge.second == 0; });
+}
+
+} // namespace
+
+// Project polygons into a Polygon2d instance.
+// Filtering by the sign of the normal vector is prone to floating point
+// uncertainties, so faces are only dropped when that can't matter: on a closed
+// surface the faces facing one way already cover the whole shadow, so faces
+// that clearly face the other way can be skipped. Near-vertical faces are
+// always kept.
 std::unique_ptr<Polygon2d> project(const PolySet& ps) {
   auto poly = std::make_unique<Polygon2d>();
 
-  Vector3d pt;
+  const bool cull_back_faces = isClosedSurface(ps);
+  double min_area = 0;
+  if (cull_back_faces) {
+    const auto size = ps.getBoundingBox().sizes();
+    min_area = -1e-9 * (size[0] * size[0] + size[1] * size[1]);
+  }
+
   for (const auto& p : ps.indices) {
     Outline2d outline;
+    outline.vertices.reserve(p.size());
     for (const auto& v : p) {
-      pt=ps.vertices[v];
+      const auto& pt = ps.vertices[v];
       outline.vertices.emplace_back(pt[0], pt[1]);
     }
-    poly->addOutline(outline);
+    if (cull_back_faces) {
+      double area2 = 0;
+      for (size_t i = 0, n = outline.vertices.size(); i < n; ++i) {
+        const auto& v1 = outline.vertices[i];
+        const auto& v2 = outline.vertices[(i + 1) % n];
+        area2 += v1[0] * v2[1] - v2[0] * v1[1];
+      }
+      if (area2 / 2 < min_area) continue;
+    }
+    poly->addOutline(std::move(outline));
   }
   return poly;
 }
@@ -132,30 +177,33 @@ std::unique_ptr<PolySet> tessellate_faces(const PolySet& polyset)
     }
   }
 
-  // we will reuse this memory instead of reallocating for each polygon
-  std::vector<IndexedTriangle> triangles;
-  std::vector<IndexedFace> facesBuffer(1);
+  // Triangles are passed through. Everything else goes through libtess2,
+  // one independent job per face, run in parallel.
+  std::vector<size_t> complexFaces;
   for (size_t i = 0, n = polygons.size(); i < n; i++) {
+    if (polygons[i].size() > 3) complexFaces.push_back(i);
+  }
+  std::vector<std::vector<IndexedTriangle>> complexTriangles(complexFaces.size());
+  parallelizable_for(size_t{0}, complexFaces.size(), [&](size_t j) {
+    const std::vector<IndexedFace> faces{polygons[complexFaces[j]]};
+    if (GeometryUtils::tessellatePolygonWithHoles(verts, faces, complexTriangles[j], nullptr)) {
+      complexTriangles[j].clear();
+    }
+  });
+
+  // Merge in face order, so the output doesn't depend on scheduling
+  auto addTriangle = [&](const IndexedTriangle& t, size_t i) {
+    result->indices.push_back({t[0], t[1], t[2]});
+    if (has_colors) result->color_indices.push_back(polygon_color_indices[i]);
+  };
+  for (size_t i = 0, j = 0, n = polygons.size(); i < n; i++) {
     const auto& face = polygons[i];
-    if (face.size() == 3) {
+    if (j < complexFaces.size() && complexFaces[j] == i) {
+      for (const auto& t : complexTriangles[j]) addTriangle(t, i);
+      j++;
+    } else {
       // trivial case - triangles cannot be concave or have holes
-       result->indices.push_back({face[0],face[1],face[2]});
-       if (has_colors)
-         result->color_indices.push_back(polygon_color_indices[i]);
-    }
-    // Quads seem trivial, but can be concave, and can have degenerate cases.
-    // So everything more complex than triangles goes into the general case.
-    else {
-      triangles.clear();
-      facesBuffer[0] = face;
-      auto err = GeometryUtils::tessellatePolygonWithHoles(verts, facesBuffer, triangles, nullptr);
-      if (!err) {
-        for (const auto& t : triangles) {
-          result->indices.push_back({t[0],t[1],t[2]});
-          if (has_colors)
-            result->color_indices.push_back(polygon_color_indices[i]);
-        }
-      }
+      addTriangle(IndexedTriangle(face[0], face[1], face[2]), i);
     }
   }
   if (degeneratePolygons > 0) {
@@ -181,6 +229,8 @@ std::shared_ptr<const PolySet> getGeometryAsPolySet(const std::shared_ptr<const
     return builder.build();
   } else if (auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     return ps;
+  } else if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return getGeometryAsPolySet(instance->materialize());
   }
 #ifdef ENABLE_CGAL
   if (auto N = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
@@ -1,11 +1,14 @@
 #include "geometry/Polygon2d.h"
 
+#include <iomanip>
 #include <sstream>
 #include <utility>
 #include <cstddef>
 #include <string>
 #include <memory>
 
+#include <boost/functional/hash.hpp>
+
 #include "utils/printutils.h"
 #ifdef ENABLE_MANIFOLD
 #include "geometry/manifold/manifoldutils.h"
@@ -80,6 +83,31 @@ std::string Polygon2d::dump() const
   return out.str();
 }
 
+std::string Polygon2d::fingerprint() const
+{
+  // Two independently seeded hashes plus the sizes make accidental
+  // collisions between different polygons practically impossible.
+  size_t seed1 = 0;
+  size_t seed2 = 0x9e3779b97f4a7c15ull;
+  size_t num_vertices = 0;
+  for (const auto& o : this->theoutlines) {
+    boost::hash_combine(seed1, o.positive);
+    boost::hash_combine(seed2, o.vertices.size());
+    for (const auto& v : o.vertices) {
+      boost::hash_combine(seed1, v[0]);
+      boost::hash_combine(seed1, v[1]);
+      boost::hash_combine(seed2, v[1]);
+      boost::hash_combine(seed2, v[0]);
+    }
+    num_vertices += o.vertices.size();
+  }
+  std::ostringstream out;
+  out << std::hex << std::setfill('0') << std::setw(16) << seed1 << std::setw(16) << seed2 << std::dec
+      << '/' << this->theoutlines.size() << '/' << num_vertices
+      << (this->sanitized ? "s" : "");
+  return out.str();
+}
+
 bool Polygon2d::isEmpty() const
 {
   return this->theoutlines.empty();
@@ -29,6 +29,8 @@ public:
   [[nodiscard]] size_t memsize() const override;
   [[nodiscard]] BoundingBox getBoundingBox() const override;
   [[nodiscard]] std::string dump() const override;
+  // Content hash of the outlines, for caching results independently of node identity.
+  [[nodiscard]] std::string fingerprint() const;
   [[nodiscard]] unsigned int getDimension() const override { return 2; }
   [[nodiscard]] bool isEmpty() const override;
   [[nodiscard]] std::unique_ptr<Geometry> copy() const override;
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstddef>
-#include <unordered_map>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <vector>
 #include <algorithm>
 #include "utils/hash.h" // IWYU pragma: keep
@@ -12,6 +14,10 @@
    a new array or to merge two index tables to two arrays into a common index.
    The latter is necessary for VBO's or for unifying texture coordinate indices to
    multiple texture coordinate arrays.
+
+   Elements are stored contiguously in insertion order, and looked up through an
+   open addressing (linear probing) table of indices into that array, so a
+   lookup touches no per-element heap nodes.
  */
 template <typename T>
 class Reindexer
@@ -21,11 +27,23 @@ public:
      Looks up a value. Will insert the value if it doesn't already exist.
      Returns the new index. */
   int lookup(const T& val) {
-    auto iter = this->map.find(val);
-    if (iter != this->map.end()) return iter->second;
-    else {
-      this->map.insert(std::make_pair(val, this->map.size()));
-      return this->map.size() - 1;
+    return lookup(val, hashOf(val));
+  }
+
+  /*!
+     Looks up a range of values, writing their indices to dest.
+     The hashes are computed in one pass over the input before probing,
+     which keeps that loop tight when inserting many elements at once.
+   */
+  template <class InputIterator, class OutputIterator>
+  void lookup(InputIterator begin, InputIterator end, OutputIterator dest) {
+    this->batch_hashes.clear();
+    std::transform(begin, end, std::back_inserter(this->batch_hashes), [](const T& val) { return hashOf(val); });
+    // Only the table is sized for the batch; vec grows geometrically, as reserving its exact size
+    // per batch would copy the whole array every time
+    rehash((this->vec.size() + this->batch_hashes.size()) * 2);
+    for (const auto hash : this->batch_hashes) {
+      *dest++ = lookup(*begin++, hash);
     }
   }
 
@@ -33,36 +51,78 @@ public:
      Returns the current size of the new element array
    */
   [[nodiscard]] std::size_t size() const {
-    return this->map.size();
+    return this->vec.size();
   }
 
   /*!
      Reserve the requested size for the new element map
    */
   void reserve(std::size_t n) {
-    return this->map.reserve(n);
+    this->vec.reserve(n);
+    if (n * 2 > this->table.size()) rehash(n * 2);
   }
 
   /*!
-     Return a copy of the new element array
+     Return the new element array
    */
-  const std::vector<T>& getArray() {
-    this->vec.resize(this->map.size());
-    for (const auto& entry : map) {
-      this->vec[entry.second] = entry.first;
-    }
+  const std::vector<T>& getArray() const {
     return this->vec;
   }
 
   /*!
      Copies the internal vector to the given destination
    */
-  template <class OutputIterator> void copy(OutputIterator dest) {
-    this->getArray();
+  template <class OutputIterator> void copy(OutputIterator dest) const {
     std::copy(this->vec.begin(), this->vec.end(), dest);
   }
 
 private:
-  std::unordered_map<T, int> map;
+  struct Slot {
+    int32_t index{-1};
+    uint32_t hash{0};
+  };
+
+  static uint32_t hashOf(const T& val) {
+    // Mix the bits, since the table index is taken from the low bits
+    uint64_t h = std::hash<T>{}(val);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<uint32_t>(h);
+  }
+
+  int lookup(const T& val, uint32_t hash) {
+    // Keep the load factor at or below 1/2
+    if ((this->vec.size() + 1) * 2 > this->table.size()) rehash(this->table.size() * 2);
+    const size_t mask = this->table.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      Slot& slot = this->table[i];
+      if (slot.index < 0) {
+        slot.index = static_cast<int32_t>(this->vec.size());
+        slot.hash = hash;
+        this->vec.push_back(val);
+        return slot.index;
+      }
+      if (slot.hash == hash && this->vec[slot.index] == val) return slot.index;
+    }
+  }
+
+  void rehash(std::size_t min_slots) {
+    std::size_t slots = 16;
+    while (slots < min_slots) slots *= 2;
+    if (slots <= this->table.size()) return;
+    std::vector<Slot> old(slots);
+    old.swap(this->table);
+    const size_t mask = slots - 1;
+    for (const auto& slot : old) {
+      if (slot.index < 0) continue;
+      size_t i = slot.hash & mask;
+      while (this->table[i].index >= 0) i = (i + 1) & mask;
+      this->table[i] = slot;
+    }
+  }
+
   std::vector<T> vec;
+  std::vector<Slot> table;
+  std::vector<uint32_t> batch_hashes;
 };
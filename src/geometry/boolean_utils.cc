@@ -1,5 +1,6 @@
 #include "geometry/boolean_utils.h"
 
+#include <algorithm>
 #include <iterator>
 #include <cassert>
 #include <list>
@@ -27,75 +28,199 @@
 #include "Feature.h"
 #include "glview/RenderSettings.h"
 #include "geometry/PolySet.h"
+#include "geometry/InstancedGeometry.h"
+#include "geometry/ConversionCache.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 #include "core/progress.h"
 #include "core/node.h"
 
-#include "geometry/Reindexer.h"
 #include "geometry/GeometryUtils.h"
 
 #ifdef ENABLE_CGAL
-std::unique_ptr<PolySet> applyHull(const Geometry::Geometries& children)
+namespace {
+
+// Akl-Toussaint heuristic: the points extreme along a fixed set of directions
+// span a polytope contained in the hull, so anything strictly inside it can't
+// be a hull vertex. Cheap to test, and typically removes most of the input
+// when hulling dense meshes.
+void discardInteriorPoints(std::vector<Vector3d>& points)
 {
+  if (points.size() < 64) return;
+
+  std::vector<Vector3d> directions;
+  for (int x = -1; x <= 1; ++x) {
+    for (int y = -1; y <= 1; ++y) {
+      for (int z = -1; z <= 1; ++z) {
+        if (x || y || z) directions.emplace_back(x, y, z);
+      }
+    }
+  }
+
+  std::vector<size_t> extreme_indices(directions.size());
+  parallelizable_for(size_t{0}, directions.size(), [&](size_t d) {
+    const Vector3d& dir = directions[d];
+    size_t best = 0;
+    double best_dot = dir.dot(points[0]);
+    for (size_t i = 1; i < points.size(); ++i) {
+      const double dot = dir.dot(points[i]);
+      if (dot > best_dot) {
+        best_dot = dot;
+        best = i;
+      }
+    }
+    extreme_indices[d] = best;
+  });
+  std::sort(extreme_indices.begin(), extreme_indices.end());
+  extreme_indices.erase(std::unique(extreme_indices.begin(), extreme_indices.end()), extreme_indices.end());
+  if (extreme_indices.size() < 4) return;
+
   using K = CGAL::Epick;
-  // Collect point cloud
-  Reindexer<K::Point_3> reindexer;
+  std::vector<K::Point_3> extreme_points;
+  extreme_points.reserve(extreme_indices.size());
+  Vector3d centroid = Vector3d::Zero();
+  for (const auto i : extreme_indices) {
+    extreme_points.emplace_back(points[i].x(), points[i].y(), points[i].z());
+    centroid += points[i];
+  }
+  centroid /= static_cast<double>(extreme_indices.size());
 
-  auto addCapacity = [&](const auto n) {
-    reindexer.reserve(reindexer.size() + n);
-  };
+  CGAL::Polyhedron_3<K> filter;
+  try {
+    CGAL::convex_hull_3(extreme_points.begin(), extreme_points.end(), filter);
+  } catch (const CGAL::Failure_exception&) {
+    return;
+  }
+  if (!filter.is_closed() || filter.size_of_facets() < 4) return;
+
+  // Outward facing planes n.x <= d of the filter polytope
+  std::vector<std::pair<Vector3d, double>> planes;
+  planes.reserve(filter.size_of_facets());
+  for (auto f = filter.facets_begin(); f != filter.facets_end(); ++f) {
+    auto h = f->facet_begin();
+    const auto p0 = CGALUtils::vector_convert<Vector3d>(h->vertex()->point());
+    const auto p1 = CGALUtils::vector_convert<Vector3d>((++h)->vertex()->point());
+    const auto p2 = CGALUtils::vector_convert<Vector3d>((++h)->vertex()->point());
+    Vector3d n = (p1 - p0).cross(p2 - p0);
+    const double len = n.norm();
+    if (len == 0) return;
+    n /= len;
+    if (n.dot(centroid - p0) > 0) n = -n;
+    planes.emplace_back(n, n.dot(p0));
+  }
+
+  BoundingBox bbox;
+  for (const auto& p : points) bbox.extend(p);
+  const double eps = 1e-9 * bbox.sizes().norm();
+
+  std::vector<char> inside(points.size());
+  constexpr size_t chunk_size = 4096;
+  const size_t num_chunks = (points.size() + chunk_size - 1) / chunk_size;
+  parallelizable_for(size_t{0}, num_chunks, [&](size_t chunk) {
+    const size_t end = std::min(points.size(), (chunk + 1) * chunk_size);
+    for (size_t i = chunk * chunk_size; i < end; ++i) {
+      bool strictly_inside = true;
+      for (const auto& [n, d] : planes) {
+        if (n.dot(points[i]) > d - eps) {
+          strictly_inside = false;
+          break;
+        }
+      }
+      inside[i] = strictly_inside;
+    }
+  });
+
+  size_t out = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (!inside[i]) points[out++] = points[i];
+  }
+  PRINTDB("Hull prefilter: kept %d of %d points", out % points.size());
+  points.resize(out);
+}
+
+} // namespace
 
-  auto addPoint = [&](const auto& v) {
-    reindexer.lookup(v);
+std::unique_ptr<PolySet> applyHull(const Geometry::Geometries& children)
+{
+  // Collect point cloud
+  std::vector<Vector3d> points;
+
+  // Only vertices referenced by a face contribute; each one is added once.
+  auto addPolySetPoints = [&](const PolySet& ps, const auto& place) {
+    std::vector<bool> used(ps.vertices.size());
+    for (const auto& p : ps.indices) {
+      for (const auto& ind : p) used[ind] = true;
+    }
+    points.reserve(points.size() + ps.vertices.size());
+    for (size_t i = 0; i < ps.vertices.size(); ++i) {
+      if (used[i]) points.push_back(place(ps.vertices[i]));
+    }
   };
 
   for (const auto& item : children) {
     auto& chgeom = item.second;
-#ifdef ENABLE_CGAL
     if (const auto *N = dynamic_cast<const CGAL_Nef_polyhedron*>(chgeom.get())) {
       if (!N->isEmpty()) {
-        addCapacity(N->p3->number_of_vertices());
+        points.reserve(points.size() + N->p3->number_of_vertices());
         for (CGAL_Nef_polyhedron3::Vertex_const_iterator i = N->p3->vertices_begin(); i != N->p3->vertices_end(); ++i) {
-          addPoint(CGALUtils::vector_convert<K::Point_3>(i->point()));
+          points.push_back(CGALUtils::vector_convert<Vector3d>(i->point()));
         }
       }
-#endif  // ENABLE_CGAL
 #ifdef ENABLE_MANIFOLD
     } else if (const auto *mani = dynamic_cast<const ManifoldGeometry*>(chgeom.get())) {
-      addCapacity(mani->numVertices());
+      points.reserve(points.size() + mani->numVertices());
       mani->foreachVertexUntilTrue([&](auto& p) {
-          addPoint(CGALUtils::vector_convert<K::Point_3>(p));
+          points.push_back(CGALUtils::vector_convert<Vector3d>(p));
           return false;
         });
 #endif  // ENABLE_MANIFOLD
     } else if (const auto *ps = dynamic_cast<const PolySet*>(chgeom.get())) {
-      addCapacity(ps->indices.size() * 3);
-      for (const auto& p : ps->indices) {
-        for (const auto& ind : p) {
-          addPoint(CGALUtils::vector_convert<K::Point_3>(ps->vertices[ind]));
-        }
-      }
+      addPolySetPoints(*ps, [](const Vector3d& v) { return v; });
+    } else if (const auto *instance = dynamic_cast<const InstancedGeometry*>(chgeom.get())) {
+      // Only the placed points are needed, so don't copy the mesh
+      const auto *base = dynamic_cast<const PolySet*>(instance->getBase().get());
+      assert(base);
+      addPolySetPoints(*base, [&](const Vector3d& v) { return instance->transformed(v); });
     }
   }
 
-  const auto &points = reindexer.getArray();
+  discardInteriorPoints(points);
+
+  std::sort(points.begin(), points.end(), [](const Vector3d& a, const Vector3d& b) {
+    return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+  });
+  points.erase(std::unique(points.begin(), points.end()), points.end());
   if (points.size() <= 3) return nullptr;
 
-  // Apply hull
-  if (points.size() >= 4) {
-    try {
-      CGAL::Polyhedron_3<K> r;
-      CGAL::convex_hull_3(points.begin(), points.end(), r);
-      PRINTDB("After hull vertices: %d", r.size_of_vertices());
-      PRINTDB("After hull facets: %d", r.size_of_facets());
-      PRINTDB("After hull closed: %d", r.is_closed());
-      PRINTDB("After hull valid: %d", r.is_valid());
-      // FIXME: Make sure PolySet is set to convex.
-      // FIXME: Can we guarantee a manifold PolySet here?
-      return CGALUtils::createPolySetFromPolyhedron(r);
-    } catch (const CGAL::Failure_exception& e) {
-      LOG(message_group::Error, "CGAL error in applyHull(): %1$s", e.what());
+#ifdef ENABLE_MANIFOLD
+  if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
+    if (auto hull = ManifoldUtils::createConvexHull(points)) {
+      return hull;
     }
+    PRINTD("Manifold hull failed, falling back to CGAL");
+  }
+#endif  // ENABLE_MANIFOLD
+
+  // Apply hull
+  using K = CGAL::Epick;
+  std::vector<K::Point_3> hull_points;
+  hull_points.reserve(points.size());
+  for (const auto& p : points) {
+    hull_points.emplace_back(p.x(), p.y(), p.z());
+  }
+  try {
+    CGAL::Polyhedron_3<K> r;
+    CGAL::convex_hull_3(hull_points.begin(), hull_points.end(), r);
+    PRINTDB("After hull vertices: %d", r.size_of_vertices());
+    PRINTDB("After hull facets: %d", r.size_of_facets());
+    PRINTDB("After hull closed: %d", r.is_closed());
+    PRINTDB("After hull valid: %d", r.is_valid());
+    // FIXME: Can we guarantee a manifold PolySet here?
+    auto ps = CGALUtils::createPolySetFromPolyhedron(r);
+    if (ps) ps->setConvexValue(true);
+    return ps;
+  } catch (const CGAL::Failure_exception& e) {
+    LOG(message_group::Error, "CGAL error in applyHull(): %1$s", e.what());
   }
   return nullptr;
 }
@@ -112,187 +237,176 @@ std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& child
     return ManifoldUtils::applyMinkowskiManifold(children);
   }
 #endif  // ENABLE_MANIFOLD
-  CGAL::Timer t, t_tot;
-  assert(children.size() >= 2);
-  auto it = children.begin();
-  t_tot.start();
-  std::shared_ptr<const Geometry> operands[2] = {it->second, std::shared_ptr<const Geometry>()};
-  try {
-    while (++it != children.end()) {
-      operands[1] = it->second;
-
-      using Hull_kernel = CGAL::Epick;
-
-      std::list<CGAL_Polyhedron> P[2];
-      std::list<CGAL::Polyhedron_3<Hull_kernel>> result_parts;
-
-      for (size_t i = 0; i < 2; ++i) {
-        CGAL_Polyhedron poly;
-
-        auto ps = std::dynamic_pointer_cast<const PolySet>(operands[i]);
-        auto nef = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(operands[i]);
-
-        if (!nef) {
-          nef = CGALUtils::getNefPolyhedronFromGeometry(operands[i]);
-        }
-
-        if (ps) CGALUtils::createPolyhedronFromPolySet(*ps, poly);
-        else if (nef && nef->p3->is_simple()) CGALUtils::convertNefToPolyhedron(*nef->p3, poly);
-        else throw 0;
-
-        if ((ps && ps->isConvex()) ||
-            (!ps && CGALUtils::is_weakly_convex(poly))) {
-          PRINTDB("Minkowski: child %d is convex and %s", i % (ps?"PolySet":"Nef"));
-          P[i].push_back(poly);
-        } else {
-          CGAL_Nef_polyhedron3 decomposed_nef;
-
-          if (ps) {
-            PRINTDB("Minkowski: child %d is nonconvex PolySet, transforming to Nef and decomposing...", i);
-            auto p = CGALUtils::getNefPolyhedronFromGeometry(ps);
-            if (p && !p->isEmpty()) decomposed_nef = *p->p3;
-          } else {
-            PRINTDB("Minkowski: child %d is nonconvex Nef, decomposing...", i);
-            decomposed_nef = *nef->p3;
-          }
+  using Hull_kernel = CGAL::Epick;
+  using Hull_Points = std::vector<Hull_kernel::Point_3>;
+  using Convex_Parts = std::vector<Hull_Points>;
+
+  CGAL::Cartesian_converter<CGAL_Kernel3, Hull_kernel> conv;
+  auto getHullPoints = [&](const CGAL_Polyhedron& poly) {
+    Hull_Points out;
+    out.reserve(poly.size_of_vertices());
+    for (CGAL_Polyhedron::Vertex_const_iterator pi = poly.vertices_begin(); pi != poly.vertices_end(); ++pi) {
+      out.push_back(conv(pi->point()));
+    }
+    return out;
+  };
 
-          t.start();
-          CGAL::convex_decomposition_3(decomposed_nef);
-
-          // the first volume is the outer volume, which ignored in the decomposition
-          CGAL_Nef_polyhedron3::Volume_const_iterator ci = ++decomposed_nef.volumes_begin();
-          for (; ci != decomposed_nef.volumes_end(); ++ci) {
-            if (ci->mark()) {
-              CGAL_Polyhedron poly;
-              decomposed_nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
-              P[i].push_back(poly);
-            }
-          }
+  // Splits an operand into convex parts, keeping only the points of each
+  // part since that's all the pairwise hulls need.
+  auto decompose = [&](const std::shared_ptr<const Geometry>& operand) -> std::shared_ptr<const Convex_Parts> {
+    auto parts = std::make_shared<Convex_Parts>();
+    CGAL_Polyhedron poly;
+
+    auto ps = std::dynamic_pointer_cast<const PolySet>(operand);
+    std::shared_ptr<const CGAL_Nef_polyhedron> nef;
+    if (!ps) nef = CGALUtils::getNefPolyhedronFromGeometry(operand);
+
+    if (ps) CGALUtils::createPolyhedronFromPolySet(*ps, poly);
+    else if (nef && nef->p3->is_simple()) CGALUtils::convertNefToPolyhedron(*nef->p3, poly);
+    else throw 0;
+
+    if ((ps && ps->isConvex()) ||
+        (!ps && CGALUtils::is_weakly_convex(poly))) {
+      PRINTDB("Minkowski: child is convex and %s", (ps?"PolySet":"Nef"));
+      parts->push_back(getHullPoints(poly));
+    } else {
+      CGAL_Nef_polyhedron3 decomposed_nef;
+
+      if (ps) {
+        PRINTD("Minkowski: child is nonconvex PolySet, transforming to Nef and decomposing...");
+        auto p = CGALUtils::getNefPolyhedronFromGeometry(ps);
+        if (p && !p->isEmpty()) decomposed_nef = *p->p3;
+      } else {
+        PRINTD("Minkowski: child is nonconvex Nef, decomposing...");
+        decomposed_nef = *nef->p3;
+      }
 
+      CGAL::convex_decomposition_3(decomposed_nef);
 
-          PRINTDB("Minkowski: decomposed into %d convex parts", P[i].size());
-          t.stop();
-          PRINTDB("Minkowski: decomposition took %f s", t.time());
+      // the first volume is the outer volume, which ignored in the decomposition
+      CGAL_Nef_polyhedron3::Volume_const_iterator ci = ++decomposed_nef.volumes_begin();
+      for (; ci != decomposed_nef.volumes_end(); ++ci) {
+        if (ci->mark()) {
+          CGAL_Polyhedron poly;
+          decomposed_nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
+          parts->push_back(getHullPoints(poly));
         }
       }
+      PRINTDB("Minkowski: decomposed into %d convex parts", parts->size());
+    }
+    return parts;
+  };
+  auto partsCost = [](const Convex_Parts& parts) {
+    size_t count = 0;
+    for (const auto& points : parts) count += points.size();
+    return count * sizeof(Hull_kernel::Point_3);
+  };
 
-      std::vector<Hull_kernel::Point_3> points[2];
-      std::vector<Hull_kernel::Point_3> minkowski_points;
-
-      CGAL::Cartesian_converter<CGAL_Kernel3, Hull_kernel> conv;
-
-      for (size_t i = 0; i < P[0].size(); ++i) {
-        for (size_t j = 0; j < P[1].size(); ++j) {
-          t.start();
-          points[0].clear();
-          points[1].clear();
-
-          for (int k = 0; k < 2; ++k) {
-            auto it = P[k].begin();
-            std::advance(it, k == 0?i:j);
-
-            CGAL_Polyhedron const& poly = *it;
-            points[k].reserve(poly.size_of_vertices());
-
-            for (CGAL_Polyhedron::Vertex_const_iterator pi = poly.vertices_begin(); pi != poly.vertices_end(); ++pi) {
-              CGAL_Polyhedron::Point_3 const& p = pi->point();
-              points[k].push_back(conv(p));
-            }
-          }
-
-          minkowski_points.clear();
-          minkowski_points.reserve(points[0].size() * points[1].size());
-          for (size_t i = 0; i < points[0].size(); ++i) {
-            for (size_t j = 0; j < points[1].size(); ++j) {
-              minkowski_points.push_back(points[0][i] + (points[1][j] - CGAL::ORIGIN));
-            }
-          }
-
-          if (minkowski_points.size() <= 3) {
-            t.stop();
-            continue;
-          }
-
-          CGAL::Polyhedron_3<Hull_kernel> result;
-          t.stop();
-          PRINTDB("Minkowski: Point cloud creation (%d ⨉ %d -> %d) took %f ms", points[0].size() % points[1].size() % minkowski_points.size() % (t.time() * 1000));
-          t.reset();
-
-          t.start();
-
-          CGAL::convex_hull_3(minkowski_points.begin(), minkowski_points.end(), result);
+  // Convex hull of the pairwise sums of two convex parts
+  auto combineParts = [](const Hull_Points& points0, const Hull_Points& points1) -> std::shared_ptr<const Geometry> {
+    std::vector<Hull_kernel::Point_3> minkowski_points;
+    minkowski_points.reserve(points0.size() * points1.size());
+    for (const auto& p0 : points0) {
+      for (const auto& p1 : points1) {
+        minkowski_points.push_back(p0 + (p1 - CGAL::ORIGIN));
+      }
+    }
 
-          std::vector<Hull_kernel::Point_3> strict_points;
-          strict_points.reserve(minkowski_points.size());
+    if (minkowski_points.size() <= 3) return nullptr;
 
-          for (CGAL::Polyhedron_3<Hull_kernel>::Vertex_iterator i = result.vertices_begin(); i != result.vertices_end(); ++i) {
-            Hull_kernel::Point_3 const& p = i->point();
+    CGAL::Polyhedron_3<Hull_kernel> result;
+    CGAL::convex_hull_3(minkowski_points.begin(), minkowski_points.end(), result);
 
-            CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle h, e;
-            h = i->halfedge();
-            e = h;
-            bool collinear = false;
-            bool coplanar = true;
+    std::vector<Hull_kernel::Point_3> strict_points;
+    strict_points.reserve(minkowski_points.size());
 
-            do {
-              Hull_kernel::Point_3 const& q = h->opposite()->vertex()->point();
-              if (coplanar && !CGAL::coplanar(p, q,
-                                              h->next_on_vertex()->opposite()->vertex()->point(),
-                                              h->next_on_vertex()->next_on_vertex()->opposite()->vertex()->point())) {
-                coplanar = false;
-              }
+    for (CGAL::Polyhedron_3<Hull_kernel>::Vertex_iterator i = result.vertices_begin(); i != result.vertices_end(); ++i) {
+      Hull_kernel::Point_3 const& p = i->point();
 
+      CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle h, e;
+      h = i->halfedge();
+      e = h;
+      bool collinear = false;
+      bool coplanar = true;
 
-              for (CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle j = h->next_on_vertex();
-                   j != h && !collinear && !coplanar;
-                   j = j->next_on_vertex()) {
+      do {
+        Hull_kernel::Point_3 const& q = h->opposite()->vertex()->point();
+        if (coplanar && !CGAL::coplanar(p, q,
+                                        h->next_on_vertex()->opposite()->vertex()->point(),
+                                        h->next_on_vertex()->next_on_vertex()->opposite()->vertex()->point())) {
+          coplanar = false;
+        }
 
-                Hull_kernel::Point_3 const& r = j->opposite()->vertex()->point();
-                if (CGAL::collinear(p, q, r)) {
-                  collinear = true;
-                }
-              }
 
-              h = h->next_on_vertex();
-            } while (h != e && !collinear);
+        for (CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle j = h->next_on_vertex();
+             j != h && !collinear && !coplanar;
+             j = j->next_on_vertex()) {
 
-            if (!collinear && !coplanar) strict_points.push_back(p);
+          Hull_kernel::Point_3 const& r = j->opposite()->vertex()->point();
+          if (CGAL::collinear(p, q, r)) {
+            collinear = true;
           }
+        }
 
-          result.clear();
-          CGAL::convex_hull_3(strict_points.begin(), strict_points.end(), result);
+        h = h->next_on_vertex();
+      } while (h != e && !collinear);
 
+      if (!collinear && !coplanar) strict_points.push_back(p);
+    }
 
-          t.stop();
-          PRINTDB("Minkowski: Computing convex hull took %f s", t.time());
-          t.reset();
+    result.clear();
+    CGAL::convex_hull_3(strict_points.begin(), strict_points.end(), result);
+    return CGALUtils::createPolySetFromPolyhedron(result);
+  };
 
-          result_parts.push_back(result);
-        }
+  CGAL::Timer t, t_tot;
+  assert(children.size() >= 2);
+  auto it = children.begin();
+  t_tot.start();
+  std::shared_ptr<const Geometry> operands[2] = {InstancedGeometry::resolve(it->second), std::shared_ptr<const Geometry>()};
+  try {
+    while (++it != children.end()) {
+      operands[1] = InstancedGeometry::resolve(it->second);
+
+      // Decompositions are kept with the operand, so the same part used in
+      // several minkowski() calls (or renders) is only decomposed once.
+      // They are computed one at a time, as the exact Nef polyhedra may be
+      // shared between the operands.
+      t.start();
+      std::shared_ptr<const Convex_Parts> P[2];
+      for (size_t i = 0; i < 2; ++i) {
+        P[i] = ConversionCache::instance()->getData<Convex_Parts>(
+          operands[i], "minkowski-convex-parts", [&]() { return decompose(operands[i]); }, partsCost);
       }
+      t.stop();
+      PRINTDB("Minkowski: decomposition phase took %f s", t.time());
+      t.reset();
+
+      // The pairwise hulls only use inexact points, so they can be computed in parallel
+      t.start();
+      std::vector<std::shared_ptr<const Geometry>> hulls(P[0]->size() * P[1]->size());
+      parallelizable_cross_product_transform(*P[0], *P[1], hulls.begin(), combineParts);
+      Geometry::Geometries result_parts;
+      for (auto& hull : hulls) {
+        if (hull) result_parts.emplace_back(std::shared_ptr<const AbstractNode>(), std::move(hull));
+      }
+      t.stop();
+      PRINTDB("Minkowski: hull phase (%d parts) took %f s", result_parts.size() % t.time());
+      t.reset();
 
       if (it != std::next(children.begin())) operands[0].reset();
 
-      auto partToGeom = [&](auto& poly) -> std::shared_ptr<const Geometry> {
-          return CGALUtils::createPolySetFromPolyhedron(poly);
-        };
-
       if (result_parts.size() == 1) {
-        operands[0] = partToGeom(*result_parts.begin());
+        operands[0] = result_parts.front().second;
       } else if (!result_parts.empty()) {
         t.start();
         PRINTDB("Minkowski: Computing union of %d parts", result_parts.size());
-        Geometry::Geometries fake_children;
-        for (const auto& part : result_parts) {
-          fake_children.push_back(std::make_pair(std::shared_ptr<const AbstractNode>(),
-                                                 partToGeom(part)));
-        }
-        auto N = CGALUtils::applyUnion3D(fake_children.begin(), fake_children.end());
+        auto N = CGALUtils::applyUnion3D(result_parts.begin(), result_parts.end());
         // FIXME: This should really never throw.
         // Assert once we figured out what went wrong with issue #1069?
         if (!N) throw 0;
         t.stop();
-        PRINTDB("Minkowski: Union done: %f s", t.time());
+        PRINTDB("Minkowski: union phase took %f s", t.time());
         t.reset();
         operands[0] = std::move(N);
       } else {
@@ -4,6 +4,7 @@
 #include <memory>
 #include <cstddef>
 #include <string>
+#include <unordered_set>
 
 #include "utils/printutils.h"
 #include "geometry/cgal/CGAL_Nef_polyhedron.h"
@@ -38,7 +39,7 @@ bool CGALCache::acceptsGeometry(const std::shared_ptr<const Geometry>& geom) {
 bool CGALCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& N)
 {
   assert(acceptsGeometry(N));
-  auto inserted = this->cache.insert(id, new cache_entry(N), N ? N->memsize() : 0);
+  auto inserted = this->cache.insert(id, new cache_entry(N, this->held), N ? N->memsize() : 0);
 #ifdef DEBUG
   if (inserted) LOG("CGAL Cache insert: %1$s (%2$d bytes)", id.substr(0, 40), (N ? N->memsize() : 0));
   else LOG("CGAL Cache insert failed: %1$s (%2$d bytes)", id.substr(0, 40), (N ? N->memsize() : 0));
@@ -77,8 +78,16 @@ void CGALCache::print()
   LOG("CGAL cache size in bytes: %1$d", this->cache.totalCost());
 }
 
-CGALCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& N)
-  : N(N)
+CGALCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& N,
+                                    std::unordered_multiset<const Geometry *>& held)
+  : N(N), held(held)
 {
   if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
+  if (N) held.insert(N.get());
+}
+
+CGALCache::cache_entry::~cache_entry()
+{
+  const auto it = held.find(N.get());
+  if (it != held.end()) held.erase(it);
 }
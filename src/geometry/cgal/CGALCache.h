@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include "geometry/Geometry.h"
 
 class CGALCache
@@ -17,6 +18,8 @@ public:
   bool contains(const std::string& id) const { return this->cache.contains(id); }
   std::shared_ptr<const Geometry> get(const std::string& id) const;
   bool insert(const std::string& id, const std::shared_ptr<const Geometry>& N);
+  // Whether N is held by one of the cache entries
+  bool holds(const Geometry *N) const { return this->held.count(N) > 0; }
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
@@ -30,8 +33,12 @@ private:
   struct cache_entry {
     std::shared_ptr<const Geometry> N;
     std::string msg;
-    cache_entry(const std::shared_ptr<const Geometry>& N);
+    std::unordered_multiset<const Geometry *>& held;
+    cache_entry(const std::shared_ptr<const Geometry>& N, std::unordered_multiset<const Geometry *>& held);
+    ~cache_entry();
   };
 
+  // Declared before the cache, as its entries remove themselves from it
+  std::unordered_multiset<const Geometry *> held;
   Cache<std::string, cache_entry> cache;
 };
@@ -7,6 +7,8 @@
 
 #include "geometry/cgal/cgal.h"
 #include "geometry/PolySet.h"
+#include "geometry/InstancedGeometry.h"
+#include "geometry/ConversionCache.h"
 #include "utils/printutils.h"
 #include "geometry/Polygon2d.h"
 #include "geometry/PolySetUtils.h"
@@ -239,7 +241,7 @@ bool is_approximately_convex(const PolySet& ps) {
   return explored_facets.size() == ps.indices.size();
 }
 
-std::shared_ptr<const CGAL_Nef_polyhedron> getNefPolyhedronFromGeometry(const std::shared_ptr<const Geometry>& geom)
+static std::shared_ptr<const CGAL_Nef_polyhedron> convertToNefPolyhedron(const std::shared_ptr<const Geometry>& geom)
 {
   if (auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     return std::shared_ptr<CGAL_Nef_polyhedron>(createNefPolyhedronFromPolySet(*ps));
@@ -248,6 +250,8 @@ std::shared_ptr<const CGAL_Nef_polyhedron> getNefPolyhedronFromGeometry(const st
     return std::shared_ptr<CGAL_Nef_polyhedron>(createNefPolyhedronFromPolySet(*ps));
   } else if (auto nef = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
     return nef;
+  } else if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return convertToNefPolyhedron(instance->materialize());
 #if ENABLE_MANIFOLD
   } else if (auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
     return std::shared_ptr<CGAL_Nef_polyhedron>(createNefPolyhedronFromPolySet(*mani->toPolySet()));
@@ -256,6 +260,17 @@ std::shared_ptr<const CGAL_Nef_polyhedron> getNefPolyhedronFromGeometry(const st
   return nullptr;
 }
 
+std::shared_ptr<const CGAL_Nef_polyhedron> getNefPolyhedronFromGeometry(const std::shared_ptr<const Geometry>& geom)
+{
+  if (auto nef = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
+    return nef;
+  }
+  auto converted = ConversionCache::instance()->get(geom, "nef", [&]() -> std::shared_ptr<const Geometry> {
+    return convertToNefPolyhedron(geom);
+  });
+  return std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(converted);
+}
+
 /*
    Create a PolySet from a Nef Polyhedron 3. return false on success,
    true on failure. The trick to this is that Nef Polyhedron3 faces have
@@ -484,6 +499,9 @@ std::shared_ptr<const PolySet> getGeometryAsPolySet(const std::shared_ptr<const
   if (auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     return ps;
   }
+  if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return getGeometryAsPolySet(instance->materialize());
+  }
   if (auto N = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
     auto ps = std::make_shared<PolySet>(3);
     if (!N->isEmpty()) {
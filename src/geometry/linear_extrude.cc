@@ -8,6 +8,7 @@
 #include <memory>
 #include <cstddef>
 #include <queue>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/logic/tribool.hpp>
@@ -20,6 +21,8 @@
 #include "geometry/PolySetUtils.h"
 #include "utils/calc.h"
 #include "utils/degree_trig.h"
+#include "utils/hash.h"
+#include "utils/parallel.h"
 
 namespace {
 
@@ -229,11 +232,61 @@ std::unique_ptr<PolySet> assemblePolySetForManifold(
   return final_polyset;
 }
 
+/*
+   Tessellates an end cap and maps its vertices onto the ring of extrusion
+   vertices starting at ring_offset, which holds the outline vertices of cap in order.
+   Returns false if that's not possible, i.e. the outline has duplicate vertices
+   or the tessellator introduced new ones.
+ */
+bool append_cap_indices(PolygonIndices& indices, const Polygon2d& cap, int ring_offset, bool flip)
+{
+  std::unordered_map<Vector3d, int> ring_index;
+  int i = 0;
+  for (const auto& o : cap.outlines()) {
+    for (const auto& v : o.vertices) {
+      if (!ring_index.emplace(Vector3d(v[0], v[1], 0.0), ring_offset + i++).second) return false;
+    }
+  }
+
+  auto ps = cap.tessellate();
+  for (const auto& p : ps->indices) {
+    IndexedFace face;
+    for (const auto idx : p) {
+      auto it = ring_index.find(ps->vertices[idx]);
+      if (it == ring_index.end()) return false;
+      face.push_back(it->second);
+    }
+    if (flip) std::reverse(face.begin(), face.end());
+    indices.push_back(std::move(face));
+  }
+  return true;
+}
+
 std::unique_ptr<PolySet> assemblePolySetForCGAL(const Polygon2d& polyref,
   std::vector<Vector3d>& vertices, PolygonIndices& indices,
   int convexity, boost::tribool isConvex,
   double scale_x, double scale_y,
-  const Vector3d& h1, const Vector3d& h2, double twist) {
+  const Vector3d& h1, const Vector3d& h2, double twist, int index_offset) {
+
+  // Unless the top collapses, the end caps can be stitched directly onto the first
+  // and last ring of vertices, so the mesh doesn't need vertex deduplication.
+  if (scale_x != 0 && scale_y != 0) {
+    Polygon2d top_poly(polyref);
+    Eigen::Affine2d trans(Eigen::Scaling(scale_x, scale_y) * Eigen::Affine2d(rotate_degrees(-twist)));
+    top_poly.transform(trans);
+
+    PolygonIndices caps;
+    if (append_cap_indices(caps, polyref, 0, true) &&
+        append_cap_indices(caps, top_poly, index_offset, false)) {
+      auto final_polyset = std::make_unique<PolySet>(3, isConvex);
+      final_polyset->setTriangular(true);
+      final_polyset->setConvexity(convexity);
+      final_polyset->vertices = std::move(vertices);
+      final_polyset->indices = std::move(indices);
+      std::move(caps.begin(), caps.end(), std::back_inserter(final_polyset->indices));
+      return final_polyset;
+    }
+  }
 
   PolySetBuilder builder(0, 0, 3, isConvex);
   builder.setConvexity(convexity);
@@ -281,7 +334,7 @@ std::unique_ptr<PolySet> assemblePolySetForCGAL(const Polygon2d& polyref,
    Quads are triangulated across the shorter of the two diagonals, which works well in most cases.
    However, when diagonals are equal length, decision may flip depending on other factors.
  */
-void add_slice_indices(PolygonIndices &indices, int slice_idx, int slice_stride, const Polygon2d& poly,
+void add_slice_indices(PolygonIndices::iterator out, int slice_idx, int slice_stride, const Polygon2d& poly,
                               double rot1, double rot2,
                               const Vector2d& scale1, const Vector2d& scale2)
 {
@@ -323,27 +376,27 @@ void add_slice_indices(PolygonIndices &indices, int slice_idx, int slice_stride,
       // Split along shortest diagonal,
       // unless at top for a 0-scaled axis (which can create 0 thickness "ears")
       if (splitfirst xor any_zero) {
-        indices.push_back({
+        *out++ = {
           prev_slice + curr_idx,
           curr_slice + curr_idx,
           prev_slice + prev_idx,
-        });
-        indices.push_back({
+        };
+        *out++ = {
           curr_slice + prev_idx,
           prev_slice + prev_idx,
           curr_slice + curr_idx,
-        });
+        };
       } else {
-        indices.push_back({
+        *out++ = {
           prev_slice + curr_idx,
           curr_slice + prev_idx,
           prev_slice + prev_idx,
-        });
-        indices.push_back({
+        };
+        *out++ = {
           prev_slice + curr_idx,
           curr_slice + curr_idx,
           curr_slice + prev_idx,
-        });
+        };
       }
       prev1 = curr1;
       prev2 = curr2;
@@ -475,44 +528,46 @@ std::unique_ptr<Geometry> extrudePolygon(const LinearExtrudeNode& node, const Po
   for (const auto& o : polyref.outlines()) {
     slice_stride += o.vertices.size();
   }
-  std::vector<Vector3d> vertices;
-  vertices.reserve(slice_stride * (num_slices + 1));
+  // Each slice is independent given its index, so vertices and side faces are
+  // generated in parallel straight into their final position in the arrays.
+  std::vector<Vector3d> vertices(slice_stride * (num_slices + 1));
   PolygonIndices indices;
   indices.reserve(slice_stride * (num_slices + 1) * 2); // sides + endcaps
+  indices.resize(slice_stride * num_slices * 2);
 
   // Calculate all vertices
   Vector2d full_scale(1 - node.scale_x, 1 - node.scale_y);
   double full_rot = -node.twist;
   auto full_height = (h2 - h1);
-  for (unsigned int slice_idx = 0; slice_idx <= num_slices; slice_idx++) {
+  parallelizable_for(0, num_slices + 1, [&](size_t slice_idx) {
     Eigen::Affine2d trans(
       Eigen::Scaling(Vector2d(1,1) - full_scale * slice_idx / num_slices) *
       Eigen::Affine2d(rotate_degrees(full_rot * slice_idx / num_slices)));
 
+    auto out = vertices.begin() + slice_stride * slice_idx;
     for (const auto& o : polyref.outlines()) {
       for (const auto& v : o.vertices) {
         auto tmp = trans * v;
-        vertices.emplace_back(Vector3d(tmp[0], tmp[1], 0.0) + h1 + full_height * slice_idx / num_slices);
+        *out++ = Vector3d(tmp[0], tmp[1], 0.0) + h1 + full_height * slice_idx / num_slices;
       }
     }
-  }
+  });
 
   // Create indices for sides
-  for (unsigned int slice_idx = 1; slice_idx <= num_slices; slice_idx++) {
+  parallelizable_for(1, num_slices + 1, [&](size_t slice_idx) {
     double rot_prev = node.twist * (slice_idx -1)/ num_slices;
     double rot_curr = node.twist * slice_idx / num_slices;
-    auto height_prev = h1 + (h2 - h1) * (slice_idx - 1) / num_slices;
-    auto height_curr = h1 + (h2 - h1) * slice_idx / num_slices;
     Vector2d scale_prev(1 - (1 - node.scale_x) * (slice_idx - 1) / num_slices,
                     1 - (1 - node.scale_y) * (slice_idx - 1) / num_slices);
     Vector2d scale_curr(1 - (1 - node.scale_x) * slice_idx / num_slices,
                     1 - (1 - node.scale_y) * slice_idx / num_slices);
-    add_slice_indices(indices, slice_idx, slice_stride, polyref, rot_prev, rot_curr, scale_prev, scale_curr);
-  }
+    add_slice_indices(indices.begin() + slice_stride * (slice_idx - 1) * 2, slice_idx, slice_stride,
+                      polyref, rot_prev, rot_curr, scale_prev, scale_curr);
+  });
 
   // For Manifold, we can tesselate the endcaps using existing vertices to build a manifold mesh.
-  // Without Manifold, however, we don't have such a tessellator available, so we'll have to build
-  // the polyset from vertices using PolySetBuilder
+  // Without Manifold, the tessellator isn't guaranteed to preserve vertices, so the endcaps are
+  // mapped back onto the outline vertices, falling back to PolySetBuilder if that fails.
 
 #ifdef ENABLE_MANIFOLD
   if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
@@ -524,5 +579,5 @@ std::unique_ptr<Geometry> extrudePolygon(const LinearExtrudeNode& node, const Po
   return assemblePolySetForCGAL(polyref, vertices, indices,
                                 node.convexity, isConvex,
                                 node.scale_x, node.scale_y,
-                                h1, h2, node.twist);
+                                h1, h2, node.twist, slice_stride * num_slices);
 }
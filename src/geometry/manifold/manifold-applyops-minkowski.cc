@@ -13,6 +13,8 @@
 #include "geometry/cgal/cgal.h"
 #include "geometry/cgal/cgalutils.h"
 #include "geometry/PolySet.h"
+#include "geometry/InstancedGeometry.h"
+#include "geometry/ConversionCache.h"
 #include "utils/printutils.h"
 #include "geometry/manifold/manifoldutils.h"
 #include "geometry/manifold/ManifoldGeometry.h"
@@ -28,6 +30,7 @@ std::shared_ptr<const Geometry> applyMinkowskiManifold(const Geometry::Geometrie
   using Hull_kernel = CGAL::Epick;
   using Hull_Mesh = CGAL::Surface_mesh<CGAL::Point_3<Hull_kernel>>;
   using Hull_Points = std::vector<Hull_kernel::Point_3>;
+  using Convex_Parts = std::vector<Hull_Points>;
   using Nef_kernel = CGAL_Kernel3;
   using Polyhedron = CGAL_Polyhedron;
 
@@ -53,7 +56,7 @@ std::shared_ptr<const Geometry> applyMinkowskiManifold(const Geometry::Geometrie
   auto it = children.begin();
   CGAL::Timer t_tot;
   t_tot.start();
-  std::vector<std::shared_ptr<const Geometry>> operands = {it->second, std::shared_ptr<const Geometry>()};
+  std::vector<std::shared_ptr<const Geometry>> operands = {InstancedGeometry::resolve(it->second), std::shared_ptr<const Geometry>()};
 
   CGAL::Cartesian_converter<Nef_kernel, Hull_kernel> conv;
   auto getHullPoints = [&](const Polyhedron &poly) {
@@ -69,12 +72,16 @@ std::shared_ptr<const Geometry> applyMinkowskiManifold(const Geometry::Geometrie
     // Note: we could parallelize more, e.g. compute all decompositions ahead of time instead of doing them 2 by 2,
     // but this could use substantially more memory.
     while (++it != children.end()) {
-      operands[1] = it->second;
+      operands[1] = InstancedGeometry::resolve(it->second);
 
-      std::vector<std::list<Hull_Points>> part_points(2);
+      CGAL::Timer t_phase;
+      t_phase.start();
+      std::vector<std::shared_ptr<const Convex_Parts>> part_points(2);
 
-      parallelizable_transform(operands.begin(), operands.begin() + 2, part_points.begin(), [&](const auto &operand) {
-        std::list<Hull_Points> part_points;
+      // Decompositions are kept with the operand, so the same part used in
+      // several minkowski() calls (or renders) is only decomposed once.
+      auto decompose = [&](const std::shared_ptr<const Geometry>& operand) -> std::shared_ptr<const Convex_Parts> {
+        auto part_points = std::make_shared<Convex_Parts>();
 
         bool is_convex;
         auto poly = polyhedronFromGeometry(operand, &is_convex);
@@ -84,7 +91,7 @@ std::shared_ptr<const Geometry> applyMinkowskiManifold(const Geometry::Geometrie
         }
 
         if (is_convex) {
-          part_points.emplace_back(getHullPoints(*poly));
+          part_points->emplace_back(getHullPoints(*poly));
         } else {
           // The CGAL_Nef_polyhedron3 constructor can crash on bad polyhedron, so don't try
           if (!poly->is_valid()) throw 0;
@@ -99,16 +106,28 @@ std::shared_ptr<const Geometry> applyMinkowskiManifold(const Geometry::Geometrie
             if (ci->mark()) {
               Polyhedron poly;
               decomposed_nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
-              part_points.emplace_back(getHullPoints(poly));
+              part_points->emplace_back(getHullPoints(poly));
             }
           }
 
-          PRINTDB("Minkowski: decomposed into %d convex parts", part_points.size());
+          PRINTDB("Minkowski: decomposed into %d convex parts", part_points->size());
           t.stop();
           PRINTDB("Minkowski: decomposition took %f s", t.time());
         }
         return part_points;
+      };
+      auto partsCost = [](const Convex_Parts& parts) {
+        size_t count = 0;
+        for (const auto& points : parts) count += points.size();
+        return count * sizeof(Hull_kernel::Point_3);
+      };
+      parallelizable_transform(operands.begin(), operands.begin() + 2, part_points.begin(), [&](const auto &operand) {
+        return ConversionCache::instance()->getData<Convex_Parts>(
+          operand, "minkowski-convex-parts", [&]() { return decompose(operand); }, partsCost);
       });
+      t_phase.stop();
+      PRINTDB("Minkowski: decomposition phase took %f s", t_phase.time());
+      t_phase.reset();
 
       std::vector<Hull_kernel::Point_3> minkowski_points;
 
@@ -186,30 +205,35 @@ std::shared_ptr<const Geometry> applyMinkowskiManifold(const Geometry::Geometrie
         return ManifoldUtils::createManifoldFromSurfaceMesh(mesh);
       };
 
-      std::vector<std::shared_ptr<const ManifoldGeometry>> result_parts(part_points[0].size() * part_points[1].size());
+      t_phase.start();
+      std::vector<std::shared_ptr<const ManifoldGeometry>> result_parts(part_points[0]->size() * part_points[1]->size());
       parallelizable_cross_product_transform(
-          part_points[0], part_points[1],
+          *part_points[0], *part_points[1],
           result_parts.begin(),
           combineParts);
+      t_phase.stop();
+      PRINTDB("Minkowski: hull phase (%d parts) took %f s", result_parts.size() % t_phase.time());
+      t_phase.reset();
 
       if (it != std::next(children.begin())) operands[0].reset();
 
-      CGAL::Timer t;
-      t.start();
+      t_phase.start();
       PRINTDB("Minkowski: Computing union of %d parts", result_parts.size());
-      Geometry::Geometries fake_children;
+      // The parts are all convex and mostly overlapping; a single batched
+      // union lets Manifold pick the order instead of folding them one by one.
+      std::vector<manifold::Manifold> part_manifolds;
+      part_manifolds.reserve(result_parts.size());
       for (const auto& part : result_parts) {
-        fake_children.push_back(std::make_pair(std::shared_ptr<const AbstractNode>(),
-                                                part));
+        if (part && !part->isEmpty()) part_manifolds.push_back(part->getManifold());
       }
-      auto N = ManifoldUtils::applyOperator3DManifold(fake_children, OpenSCADOperator::UNION);
 
       // FIXME: This should really never throw.
       // Assert once we figured out what went wrong with issue #1069?
-      if (!N) throw 0;
-      t.stop();
-      PRINTDB("Minkowski: Union done: %f s", t.time());
-      t.reset();
+      if (part_manifolds.empty()) throw 0;
+      auto N = std::make_shared<ManifoldGeometry>(manifold::Manifold::BatchBoolean(part_manifolds, manifold::OpType::Add));
+      t_phase.stop();
+      PRINTDB("Minkowski: union phase took %f s", t_phase.time());
+      t_phase.reset();
 
       N->toOriginal();
       operands[0] = N;
@@ -2,6 +2,7 @@
 #include "geometry/manifold/manifoldutils.h"
 #include "geometry/manifold/ManifoldGeometry.h"
 #include "geometry/PolySetBuilder.h"
+#include "geometry/ConversionCache.h"
 #include "Feature.h"
 #include "utils/printutils.h"
 #ifdef ENABLE_CGAL
@@ -150,6 +151,38 @@ std::shared_ptr<ManifoldGeometry> createManifoldFromTriangularPolySet(const Poly
   return std::make_shared<ManifoldGeometry>(mani, originalIDs, originalIDToColor);
 }
 
+std::shared_ptr<ManifoldGeometry> createManifoldFromTriangles(const std::vector<Vector3d>& vertices, const PolygonIndices& triangles)
+{
+  manifold::MeshGL64 meshgl;
+
+  meshgl.numProp = 3;
+  meshgl.vertProperties.reserve(vertices.size() * 3);
+  for (const auto& v : vertices) {
+    meshgl.vertProperties.push_back(v.x());
+    meshgl.vertProperties.push_back(v.y());
+    meshgl.vertProperties.push_back(v.z());
+  }
+
+  meshgl.triVerts.reserve(triangles.size() * 3);
+  for (const auto& face : triangles) {
+    assert(face.size() == 3);
+    meshgl.triVerts.push_back(face[0]);
+    meshgl.triVerts.push_back(face[1]);
+    meshgl.triVerts.push_back(face[2]);
+  }
+
+  auto mani = manifold::Manifold(meshgl).AsOriginal();
+  if (mani.Status() != Error::NoError) {
+    return nullptr;
+  }
+  std::set<uint32_t> originalIDs;
+  auto id = mani.OriginalID();
+  if (id >= 0) {
+    originalIDs.insert(id);
+  }
+  return std::make_shared<ManifoldGeometry>(mani, originalIDs);
+}
+
 std::shared_ptr<ManifoldGeometry> createManifoldFromPolySet(const PolySet& ps)
 {
   // 1. If the PolySet is already manifold, we should be able to build a Manifold object directly
@@ -238,10 +271,42 @@ std::shared_ptr<const ManifoldGeometry> createManifoldFromGeometry(const std::sh
   if (auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
     return mani;
   }
-  if (auto ps = PolySetUtils::getGeometryAsPolySet(geom)) {
-    return createManifoldFromPolySet(*ps);
+  auto converted = ConversionCache::instance()->get(geom, "manifold", [&]() -> std::shared_ptr<const Geometry> {
+    if (auto ps = PolySetUtils::getGeometryAsPolySet(geom)) {
+      return createManifoldFromPolySet(*ps);
+    }
+    return nullptr;
+  });
+  return std::dynamic_pointer_cast<const ManifoldGeometry>(converted);
+}
+
+std::unique_ptr<PolySet> createConvexHull(const std::vector<Vector3d>& points)
+{
+  std::vector<manifold::vec3> pts;
+  pts.reserve(points.size());
+  for (const auto& p : points) {
+    pts.emplace_back(p.x(), p.y(), p.z());
+  }
+
+  const auto hull = manifold::Manifold::Hull(pts);
+  if (hull.Status() != Error::NoError || hull.IsEmpty()) {
+    return nullptr;
+  }
+
+  const manifold::MeshGL64 mesh = hull.GetMeshGL64();
+  auto ps = std::make_unique<PolySet>(3, /* convex */ true);
+  ps->setTriangular(true);
+  ps->vertices.reserve(mesh.NumVert());
+  for (size_t i = 0; i + 2 < mesh.vertProperties.size(); i += mesh.numProp) {
+    ps->vertices.emplace_back(mesh.vertProperties[i], mesh.vertProperties[i + 1], mesh.vertProperties[i + 2]);
+  }
+  ps->indices.reserve(mesh.NumTri());
+  for (size_t i = 0; i + 2 < mesh.triVerts.size(); i += 3) {
+    ps->indices.push_back({static_cast<int>(mesh.triVerts[i]),
+                           static_cast<int>(mesh.triVerts[i + 1]),
+                           static_cast<int>(mesh.triVerts[i + 2])});
   }
-  return nullptr;
+  return ps;
 }
 
 Polygon2d polygonsToPolygon2d(const manifold::Polygons& polygons) {
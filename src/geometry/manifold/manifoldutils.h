@@ -1,7 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "geometry/Geometry.h"
+#include "geometry/GeometryUtils.h"
 #include "core/enums.h"
 #include "geometry/manifold/ManifoldGeometry.h"
 
@@ -10,7 +12,11 @@ namespace ManifoldUtils {
   const char* statusToString(manifold::Manifold::Error status);
 
   std::shared_ptr<ManifoldGeometry> createManifoldFromPolySet(const PolySet& ps);
+  // Builds a Manifold from a triangle mesh as-is. Returns nullptr if the mesh isn't manifold.
+  std::shared_ptr<ManifoldGeometry> createManifoldFromTriangles(const std::vector<Vector3d>& vertices, const PolygonIndices& triangles);
   std::shared_ptr<const ManifoldGeometry> createManifoldFromGeometry(const std::shared_ptr<const Geometry>& geom);
+  // Convex hull of a point cloud, using Manifold's quickhull. Returns nullptr for degenerate (e.g. coplanar) input.
+  std::unique_ptr<PolySet> createConvexHull(const std::vector<Vector3d>& points);
 
   template <class TriangleMesh>
   std::shared_ptr<ManifoldGeometry> createManifoldFromSurfaceMesh(const TriangleMesh& mesh);
@@ -28,6 +28,7 @@ bool report_glerror(const char *function) { return false; }
 
 #include "glview/OpenGLContext.h"
 std::vector<uint8_t> OpenGLContext::getFramebuffer() const { return {}; }
+std::vector<uint8_t> OpenGLContext::getFramebuffer(uint32_t width, uint32_t height) const { return {}; }
 
 #include "glview/fbo.h"
 
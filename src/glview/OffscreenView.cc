@@ -126,6 +126,18 @@ bool OffscreenView::save(std::ostream& output) const
   return save_framebuffer(this->ctx.get(), output);
 }
 
+std::vector<uint8_t> OffscreenView::getImage() const
+{
+  const auto pixels = this->ctx->getFramebuffer(this->cam.pixel_width, this->cam.pixel_height);
+  if (pixels.empty()) return {};
+
+  const size_t samplesPerPixel = 4; // R, G, B and A
+  // Flip it vertically - images read from OpenGL buffers are upside-down
+  std::vector<uint8_t> image(samplesPerPixel * this->cam.pixel_width * this->cam.pixel_height);
+  flip_image(pixels.data(), image.data(), samplesPerPixel, this->cam.pixel_width, this->cam.pixel_height);
+  return image;
+}
+
 std::string OffscreenView::getRendererInfo() const
 {
   std::ostringstream result;
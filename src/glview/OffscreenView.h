@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 #include <ostream>
+#include <vector>
 
 #include "glview/GLView.h"
 #include "glview/OpenGLContext.h"
@@ -22,6 +23,8 @@ public:
   OffscreenView(uint32_t width, uint32_t height);
   ~OffscreenView() override;
   bool save(std::ostream& output) const;
+  // RGBA pixels of the current viewport (see resizeGL()), top row first
+  [[nodiscard]] std::vector<uint8_t> getImage() const;
   std::shared_ptr<OpenGLContext> ctx;
   fbo_t *fbo;
 
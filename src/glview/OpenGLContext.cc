@@ -7,9 +7,14 @@
 #include "glview/system-gl.h"
 
 std::vector<uint8_t> OpenGLContext::getFramebuffer() const
+{
+  return getFramebuffer(this->width_, this->height_);
+}
+
+std::vector<uint8_t> OpenGLContext::getFramebuffer(uint32_t width, uint32_t height) const
 {
   const size_t samplesPerPixel = 4; // R, G, B and A
-  std::vector<uint8_t> buffer(samplesPerPixel * this->width_ * this->height_);
-  GL_CHECK(glReadPixels(0, 0, this->width_, this->height_, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data()));
+  std::vector<uint8_t> buffer(samplesPerPixel * width * height);
+  GL_CHECK(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data()));
   return buffer;
 }
@@ -17,4 +17,6 @@ public:
   virtual bool makeCurrent() const = 0;
   virtual std::string getInfo() const = 0;
   std::vector<uint8_t> getFramebuffer() const;
+  // The lower left width x height pixels of the framebuffer
+  std::vector<uint8_t> getFramebuffer(uint32_t width, uint32_t height) const;
 };
@@ -31,6 +31,39 @@ RenderBackend3D renderBackend3DFromString(std::string backend) {
   }
 }
 
+std::string renderBackendImageToString(RenderBackendImage backend) {
+  switch (backend) {
+  case RenderBackendImage::OpenGLBackend:
+    return "OpenGL";
+  case RenderBackendImage::CPUBackend:
+    return "CPU";
+  default:
+    throw std::runtime_error("Unknown image rendering backend");
+  }
+}
+
+RenderBackendImage renderBackendImageFromString(std::string backend) {
+  boost::algorithm::to_lower(backend);
+  if (backend == "opengl") {
+#ifdef NULLGL
+    LOG(message_group::Warning, "This openscad was built without OpenGL support, using the CPU image rendering backend.");
+    return RenderBackendImage::CPUBackend;
+#else
+    return RenderBackendImage::OpenGLBackend;
+#endif
+  } else if (backend == "cpu") {
+    return RenderBackendImage::CPUBackend;
+  } else {
+    if (!backend.empty()) {
+      LOG(message_group::Warning,
+          "Unknown image rendering backend '%1$s'. Using default '%2$s'.",
+          backend.c_str(),
+          renderBackendImageToString(DEFAULT_RENDERING_BACKEND_IMAGE).c_str());
+    }
+    return DEFAULT_RENDERING_BACKEND_IMAGE;
+  }
+}
+
 RenderSettings *RenderSettings::inst(bool erase) {
   static auto instance = new RenderSettings;
   if (erase) {
@@ -42,6 +75,7 @@ RenderSettings *RenderSettings::inst(bool erase) {
 
 RenderSettings::RenderSettings() {
   backend3D = DEFAULT_RENDERING_BACKEND_3D;
+  backendImage = DEFAULT_RENDERING_BACKEND_IMAGE;
   openCSGTermLimit = 100000;
   far_gl_clip_limit = 100000.0;
   img_width = 512;
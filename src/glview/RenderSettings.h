@@ -13,12 +13,28 @@ inline constexpr RenderBackend3D DEFAULT_RENDERING_BACKEND_3D = RenderBackend3D:
 std::string renderBackend3DToString(RenderBackend3D backend);
 RenderBackend3D renderBackend3DFromString(std::string backend);
 
+// How images (png export) are rendered
+enum class RenderBackendImage {
+  OpenGLBackend,
+  CPUBackend,
+};
+
+#ifdef NULLGL
+inline constexpr RenderBackendImage DEFAULT_RENDERING_BACKEND_IMAGE = RenderBackendImage::CPUBackend;
+#else
+inline constexpr RenderBackendImage DEFAULT_RENDERING_BACKEND_IMAGE = RenderBackendImage::OpenGLBackend;
+#endif
+
+std::string renderBackendImageToString(RenderBackendImage backend);
+RenderBackendImage renderBackendImageFromString(std::string backend);
+
 class RenderSettings
 {
 public:
   static RenderSettings *inst(bool erase = false);
 
   RenderBackend3D backend3D;
+  RenderBackendImage backendImage;
   unsigned int openCSGTermLimit;
   unsigned int img_width;
   unsigned int img_height;
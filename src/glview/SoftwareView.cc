@@ -0,0 +1,628 @@
+#include "glview/SoftwareView.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <Eigen/Geometry>
+
+#include "geometry/Geometry.h"
+#include "geometry/InstancedGeometry.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+#include "geometry/Polygon2d.h"
+#include "io/imageutils.h"
+#include "utils/degree_trig.h"
+#include "utils/parallel.h"
+#include "utils/printutils.h"
+#ifdef ENABLE_CGAL
+#include "geometry/cgal/CGAL_Nef_polyhedron.h"
+#endif
+
+namespace {
+
+constexpr int TILE_SIZE = 64; // must be a multiple of 4
+
+// Line widths and point sizes used by CGALRenderer and the CGAL polyhedron helpers
+constexpr float NEF_EDGE_WIDTH = 5.0f;
+constexpr float NEF_VERTEX_SIZE = 10.0f;
+constexpr float EDGE_2D_WIDTH = 2.0f;
+
+// Lines and points are drawn on top of coplanar faces
+constexpr float DEPTH_BIAS = 5e-5f;
+
+// The GL setup in GLView::initializeGL() uses two opposite directional
+// lights in eye space and the default global ambient light.
+const Eigen::Vector3d LIGHT_DIRECTION = Eigen::Vector3d(-1.0, 1.0, 1.0).normalized();
+constexpr float AMBIENT = 0.2f;
+
+Eigen::Matrix4d perspective(double fovy, double aspect, double znear, double zfar)
+{
+  const double f = 1.0 / tan_degrees(fovy / 2);
+  Eigen::Matrix4d m = Eigen::Matrix4d::Zero();
+  m(0, 0) = f / aspect;
+  m(1, 1) = f;
+  m(2, 2) = (zfar + znear) / (znear - zfar);
+  m(2, 3) = 2 * zfar * znear / (znear - zfar);
+  m(3, 2) = -1;
+  return m;
+}
+
+Eigen::Matrix4d ortho(double left, double right, double bottom, double top, double znear, double zfar)
+{
+  Eigen::Matrix4d m = Eigen::Matrix4d::Identity();
+  m(0, 0) = 2 / (right - left);
+  m(1, 1) = 2 / (top - bottom);
+  m(2, 2) = -2 / (zfar - znear);
+  m(0, 3) = -(right + left) / (right - left);
+  m(1, 3) = -(top + bottom) / (top - bottom);
+  m(2, 3) = -(zfar + znear) / (zfar - znear);
+  return m;
+}
+
+Eigen::Matrix4d lookAt(const Vector3d& eye, const Vector3d& center, const Vector3d& up)
+{
+  const Vector3d f = (center - eye).normalized();
+  const Vector3d s = f.cross(up).normalized();
+  const Vector3d u = s.cross(f);
+  Eigen::Matrix4d m = Eigen::Matrix4d::Identity();
+  m.block<1, 3>(0, 0) = s;
+  m.block<1, 3>(1, 0) = u;
+  m.block<1, 3>(2, 0) = -f;
+  return m * Transform3d(Eigen::Translation3d(-eye)).matrix();
+}
+
+Eigen::Matrix4d rotation(const Vector3d& rot)
+{
+  Transform3d m(Eigen::AngleAxisd(rot.x() * M_PI / 180, Vector3d::UnitX()) *
+                Eigen::AngleAxisd(rot.y() * M_PI / 180, Vector3d::UnitY()) *
+                Eigen::AngleAxisd(rot.z() * M_PI / 180, Vector3d::UnitZ()));
+  return m.matrix();
+}
+
+Eigen::Matrix4d translation(const Vector3d& t)
+{
+  return Transform3d(Eigen::Translation3d(t)).matrix();
+}
+
+// Clips a line in clip coordinates against the view volume.
+// Returns false if nothing is left.
+bool clipLine(Eigen::Vector4d& p0, Eigen::Vector4d& p1)
+{
+  for (int axis = 0; axis < 3; ++axis) {
+    for (const double sign : {1.0, -1.0}) {
+      // Inside when w + sign * coord >= 0
+      const double d0 = p0[3] + sign * p0[axis];
+      const double d1 = p1[3] + sign * p1[axis];
+      if (d0 < 0 && d1 < 0) return false;
+      if (d0 < 0) p0 += (p1 - p0) * (d0 / (d0 - d1));
+      else if (d1 < 0) p1 += (p0 - p1) * (d1 / (d1 - d0));
+    }
+  }
+  return true;
+}
+
+// Sutherland-Hodgman clipping of a polygon in clip coordinates against the view volume
+void clipPolygon(std::vector<Eigen::Vector4d>& polygon)
+{
+  std::vector<Eigen::Vector4d> clipped;
+  for (int axis = 0; axis < 3 && !polygon.empty(); ++axis) {
+    for (const double sign : {1.0, -1.0}) {
+      clipped.clear();
+      for (size_t i = 0; i < polygon.size(); ++i) {
+        const auto& a = polygon[i];
+        const auto& b = polygon[(i + 1) % polygon.size()];
+        const double da = a[3] + sign * a[axis];
+        const double db = b[3] + sign * b[axis];
+        if (da >= 0) clipped.push_back(a);
+        if ((da >= 0) != (db >= 0)) clipped.push_back(a + (b - a) * (da / (da - db)));
+      }
+      polygon.swap(clipped);
+      if (polygon.empty()) return;
+    }
+  }
+}
+
+Color4f litColor(const Color4f& color, const Vector3d& eye_normal)
+{
+  const float diffuse = std::abs(eye_normal.dot(LIGHT_DIRECTION));
+  const float intensity = std::min(1.0f, AMBIENT + diffuse);
+  return {color[0] * intensity, color[1] * intensity, color[2] * intensity, color[3]};
+}
+
+Color4f faceColor(const PolySet& ps, size_t face, const Color4f& default_color)
+{
+  if (face >= ps.color_indices.size()) return default_color;
+  const auto index = ps.color_indices[face];
+  if (index < 0 || static_cast<size_t>(index) >= ps.colors.size() || !ps.colors[index].isValid()) return default_color;
+  Color4f color = ps.colors[index];
+  for (int i = 0; i < 4; ++i) {
+    if (color[i] < 0) color[i] = default_color[i];
+  }
+  return color;
+}
+
+// Edges between faces which are not coplanar. Nef polyhedra are converted to
+// triangulated PolySets, and this leaves out the triangulation diagonals.
+std::vector<std::pair<int, int>> featureEdges(const PolySet& ps)
+{
+  struct EdgeFaces {
+    Vector3d normal;
+    bool feature{false};
+  };
+  std::unordered_map<std::pair<int, int>, EdgeFaces, boost::hash<std::pair<int, int>>> edges;
+  std::vector<std::pair<int, int>> order;
+  for (const auto& face : ps.indices) {
+    if (face.size() < 3) continue;
+    const Vector3d normal = (ps.vertices[face[1]] - ps.vertices[face[0]])
+                            .cross(ps.vertices[face[2]] - ps.vertices[face[0]]).normalized();
+    for (size_t i = 0; i < face.size(); ++i) {
+      const std::pair<int, int> edge = std::minmax(face[i], face[(i + 1) % face.size()]);
+      const auto [it, inserted] = edges.emplace(edge, EdgeFaces{normal, true});
+      if (inserted) order.push_back(edge);
+      else it->second.feature = it->second.normal.dot(normal) < 1 - 1e-6;
+    }
+  }
+  std::vector<std::pair<int, int>> result;
+  for (const auto& edge : order) {
+    if (edges[edge].feature) result.push_back(edge);
+  }
+  return result;
+}
+
+void blend(float *dst, const Color4f& src)
+{
+  Eigen::Map<Eigen::Array4f> d(dst);
+  d = src.array() * src[3] + d * (1.0f - src[3]);
+}
+
+}  // namespace
+
+struct SoftwareView::Tile {
+  int x0, y0, x1, y1;
+  std::vector<float> depth;
+  std::vector<float> color; // RGBA
+};
+
+SoftwareView::SoftwareView(uint32_t width, uint32_t height)
+  : width(width), height(height), colorscheme(&ColorMap::inst()->defaultColorScheme())
+{
+}
+
+void SoftwareView::setColorScheme(const std::string& cs)
+{
+  const auto colorscheme = ColorMap::inst()->findColorScheme(cs);
+  if (colorscheme) {
+    setColorScheme(*colorscheme);
+  } else {
+    LOG(message_group::UI_Warning, "SoftwareView: unknown colorscheme %1$s", cs);
+  }
+}
+
+void SoftwareView::addGeometry(const std::shared_ptr<const Geometry>& geom)
+{
+  if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+    for (const auto& item : geomlist->getChildren()) {
+      this->addGeometry(item.second);
+    }
+  } else if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    this->addGeometry(InstancedGeometry::resolve(instance));
+  } else if (const auto poly = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
+    this->objects.push_back({std::shared_ptr<const PolySet>(poly->tessellate()), poly, false});
+  } else if (const auto ps = PolySetUtils::getGeometryAsPolySet(geom)) {
+    bool nef = false;
+#ifdef ENABLE_CGAL
+    nef = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom) != nullptr;
+#endif
+    // Tessellate, in case the PolySet contains concave polygons
+    this->objects.push_back({PolySetUtils::tessellate_faces(*ps), nullptr, nef});
+  }
+}
+
+BoundingBox SoftwareView::getBoundingBox() const
+{
+  BoundingBox bbox;
+  for (const auto& object : this->objects) {
+    if (object.polygon) bbox.extend(object.polygon->getBoundingBox());
+    else bbox.extend(object.polyset->getBoundingBox());
+  }
+  return bbox;
+}
+
+Eigen::Vector3f SoftwareView::toWindow(const Eigen::Vector4d& clip) const
+{
+  const Eigen::Vector3d ndc = clip.head<3>() / clip[3];
+  return {
+    static_cast<float>((ndc.x() + 1) / 2 * this->width),
+    static_cast<float>((1 - ndc.y()) / 2 * this->height),
+    static_cast<float>(ndc.z())
+  };
+}
+
+void SoftwareView::addTriangle(const Eigen::Matrix4d& mvp, const Vector3d& p0, const Vector3d& p1, const Vector3d& p2,
+                               const Color4f& color)
+{
+  std::vector<Eigen::Vector4d> polygon{
+    mvp * p0.homogeneous(), mvp * p1.homogeneous(), mvp * p2.homogeneous()
+  };
+  clipPolygon(polygon);
+  if (polygon.size() < 3) return;
+  const Eigen::Vector3f first = toWindow(polygon[0]);
+  Eigen::Vector3f prev = toWindow(polygon[1]);
+  for (size_t i = 2; i < polygon.size(); ++i) {
+    const Eigen::Vector3f curr = toWindow(polygon[i]);
+    this->primitives.push_back({PrimitiveType::TRIANGLE, {first, prev, curr}, color});
+    prev = curr;
+  }
+}
+
+void SoftwareView::addLine(const Eigen::Matrix4d& mvp, const Eigen::Vector4d& p0, const Eigen::Vector4d& p1,
+                           const Color4f& color, float width, bool depth_test, uint16_t stipple, int stipple_factor)
+{
+  Eigen::Vector4d c0 = mvp * p0, c1 = mvp * p1;
+  if (!clipLine(c0, c1)) return;
+  Primitive line{PrimitiveType::LINE, {toWindow(c0), toWindow(c1), Eigen::Vector3f::Zero()}, color, width};
+  line.stipple = stipple;
+  line.stipple_factor = stipple_factor;
+  line.depth_test = depth_test;
+  this->primitives.push_back(line);
+}
+
+void SoftwareView::addPoint(const Eigen::Matrix4d& mvp, const Vector3d& p, const Color4f& color, float size)
+{
+  const Eigen::Vector4d c = mvp * p.homogeneous();
+  for (int axis = 0; axis < 3; ++axis) {
+    if (std::abs(c[axis]) > c[3]) return;
+  }
+  const Eigen::Vector3f w = toWindow(c);
+  this->primitives.push_back({PrimitiveType::POINT, {w, w, w}, color, size});
+}
+
+void SoftwareView::addObject(const Object& object, const Eigen::Matrix4d& projection, const Eigen::Matrix4d& modelview)
+{
+  const PolySet& ps = *object.polyset;
+  const Eigen::Matrix4d mvp = projection * modelview;
+  const Eigen::Matrix3d normal_matrix = modelview.topLeftCorner<3, 3>();
+
+  if (object.polygon) {
+    // 2D objects are drawn unlit, with their outlines on top
+    const Color4f color = ColorMap::getColor(*this->colorscheme, RenderColor::CGAL_FACE_2D_COLOR);
+    for (const auto& face : ps.indices) {
+      for (size_t i = 2; i < face.size(); ++i) {
+        this->addTriangle(mvp, ps.vertices[face[0]], ps.vertices[face[i - 1]], ps.vertices[face[i]], color);
+      }
+    }
+    const Color4f edge_color = ColorMap::getColor(*this->colorscheme, RenderColor::CGAL_EDGE_2D_COLOR);
+    for (const auto& outline : object.polygon->outlines()) {
+      for (size_t i = 0; i < outline.vertices.size(); ++i) {
+        const auto& v0 = outline.vertices[i];
+        const auto& v1 = outline.vertices[(i + 1) % outline.vertices.size()];
+        this->addLine(mvp, Eigen::Vector4d(v0[0], v0[1], 0, 1), Eigen::Vector4d(v1[0], v1[1], 0, 1),
+                      edge_color, EDGE_2D_WIDTH, false);
+      }
+    }
+    return;
+  }
+
+  // Only Nef polyhedra have a wireframe mode and edges, like in CGALRenderer
+  if (!object.nef || this->showfaces) {
+    const Color4f default_color = ColorMap::getColor(*this->colorscheme,
+                                                     object.nef ? RenderColor::CGAL_FACE_FRONT_COLOR : RenderColor::OPENCSG_FACE_FRONT_COLOR);
+    for (size_t f = 0; f < ps.indices.size(); ++f) {
+      const auto& face = ps.indices[f];
+      if (face.size() < 3) continue;
+      const Color4f color = faceColor(ps, f, default_color);
+      for (size_t i = 2; i < face.size(); ++i) {
+        const Vector3d& p0 = ps.vertices[face[0]];
+        const Vector3d& p1 = ps.vertices[face[i - 1]];
+        const Vector3d& p2 = ps.vertices[face[i]];
+        const Vector3d normal = (normal_matrix * (p1 - p0).cross(p2 - p0)).normalized();
+        this->addTriangle(mvp, p0, p1, p2, litColor(color, normal));
+      }
+    }
+  }
+
+  if (object.nef && (!this->showfaces || this->showedges)) {
+    const auto edges = featureEdges(ps);
+    const Color4f vertex_color(0xff, 0xf6, 0x7c);
+    std::vector<bool> is_vertex(ps.vertices.size());
+    for (const auto& [i0, i1] : edges) is_vertex[i0] = is_vertex[i1] = true;
+    for (size_t i = 0; i < ps.vertices.size(); ++i) {
+      if (is_vertex[i]) this->addPoint(mvp, ps.vertices[i], vertex_color, NEF_VERTEX_SIZE);
+    }
+    const Color4f edge_color = ColorMap::getColor(*this->colorscheme, RenderColor::CGAL_EDGE_FRONT_COLOR);
+    for (const auto& [i0, i1] : edges) {
+      this->addLine(mvp, ps.vertices[i0].homogeneous(), ps.vertices[i1].homogeneous(), edge_color, NEF_EDGE_WIDTH);
+    }
+  }
+}
+
+void SoftwareView::addAxes(const Eigen::Matrix4d& mvp, const Color4f& col)
+{
+  // Large gray axis cross inline with the model. w = 0 goes to infinity.
+  const Eigen::Vector4d origin(0, 0, 0, 1);
+  for (int axis = 0; axis < 3; ++axis) {
+    this->addLine(mvp, origin, Eigen::Vector4d::Unit(axis), col, 1.0f);
+    this->addLine(mvp, origin, -Eigen::Vector4d::Unit(axis), col, 1.0f, true, 0xAAAA, 3);
+  }
+}
+
+void SoftwareView::addCrosshairs(const Eigen::Matrix4d& mvp, const Color4f& col)
+{
+  const auto vd = this->cam.zoomValue() / 8;
+  for (double xf : {-1.0, 1.0}) {
+    for (double yf : {-1.0, 1.0}) {
+      this->addLine(mvp, Eigen::Vector4d(-xf * vd, -yf * vd, -vd, 1), Eigen::Vector4d(+xf * vd, +yf * vd, +vd, 1), col, 1.0f);
+    }
+  }
+}
+
+void SoftwareView::addSmallaxes(const Color4f& col)
+{
+  // Small axis cross in the lower left corner, drawn on top of everything
+  const double aspectratio = 1.0 * this->width / this->height;
+  const double scale = 90.0;
+  const Eigen::Matrix4d projection = translation(Vector3d(-0.8, -0.8, 0)) *
+                                     ortho(-scale * aspectratio, scale * aspectratio, -scale, scale, -scale, scale) *
+                                     lookAt(Vector3d(0, -1, 0), Vector3d::Zero(), Vector3d::UnitZ());
+  const Eigen::Matrix4d mvp = projection * rotation(this->cam.object_rot);
+
+  const Eigen::Vector4d origin(0, 0, 0, 1);
+  const Color4f axis_colors[] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+  for (int axis = 0; axis < 3; ++axis) {
+    this->addLine(mvp, origin, origin + 10 * Eigen::Vector4d::Unit(axis), axis_colors[axis], 1.0f, false);
+  }
+
+  // Labels are drawn in whole GL window coordinates (y up)
+  const Eigen::Matrix4d window = translation(Vector3d(-1, -1, 0)) *
+                                 Transform3d(Eigen::Scaling(2.0 / this->width, 2.0 / this->height, 1.0)).matrix();
+  const auto label = [&](int axis) {
+    const Eigen::Vector4d c = mvp * (origin + 12 * Eigen::Vector4d::Unit(axis));
+    return Eigen::Vector2d(std::round((c.x() / c[3] + 1) / 2 * this->width), std::round((c.y() / c[3] + 1) / 2 * this->height));
+  };
+  const auto label_line = [&](const Eigen::Vector2d& l, double x0, double y0, double x1, double y1) {
+    this->addLine(window, Eigen::Vector4d(l.x() + x0, l.y() + y0, 0, 1), Eigen::Vector4d(l.x() + x1, l.y() + y1, 0, 1), col, 1.0f, false);
+  };
+  const double d = 3;
+  const auto x = label(0), y = label(1), z = label(2);
+  label_line(x, -d, -d, +d, +d);
+  label_line(x, -d, +d, +d, -d);
+  label_line(y, -d, -d, +d, +d);
+  label_line(y, -d, +d, 0, 0);
+  label_line(z, -d, -d, +d, -d);
+  label_line(z, -d, +d, +d, +d);
+  label_line(z, -d, -d, +d, +d);
+}
+
+void SoftwareView::paint()
+{
+  this->primitives.clear();
+  const auto axescolor = ColorMap::getColor(*this->colorscheme, RenderColor::AXES_COLOR);
+  const auto crosshaircol = ColorMap::getColor(*this->colorscheme, RenderColor::CROSSHAIR_COLOR);
+
+  // Same transforms as GLView::setupCamera()
+  const double aspectratio = 1.0 * this->width / this->height;
+  const auto dist = this->cam.zoomValue();
+  Eigen::Matrix4d projection;
+  if (this->cam.projection == Camera::ProjectionType::PERSPECTIVE) {
+    projection = perspective(this->cam.fov, aspectratio, 0.1 * dist, 100 * dist);
+  } else {
+    const auto height = dist * tan_degrees(this->cam.fov / 2);
+    projection = ortho(-height * aspectratio, height * aspectratio, -height, height, -100 * dist, +100 * dist);
+  }
+  const Eigen::Matrix4d view = lookAt(Vector3d(0.0, -dist, 0.0), Vector3d::Zero(), Vector3d::UnitZ()) *
+                               rotation(this->cam.object_rot);
+  const Eigen::Matrix4d modelview = view * translation(this->cam.object_trans);
+
+  // The crosshair is fixed at the center of the viewport, the axes follow the object translation
+  if (this->showcrosshairs) this->addCrosshairs(projection * view, crosshaircol);
+  if (this->showaxes) this->addAxes(projection * modelview, axescolor);
+  for (const auto& object : this->objects) {
+    this->addObject(object, projection, modelview);
+  }
+  if (this->showaxes) this->addSmallaxes(axescolor);
+
+  // Bin primitives into tiles, keeping the drawing order within each tile
+  const int tiles_x = (this->width + TILE_SIZE - 1) / TILE_SIZE;
+  const int tiles_y = (this->height + TILE_SIZE - 1) / TILE_SIZE;
+  std::vector<std::vector<uint32_t>> bins(tiles_x * tiles_y);
+  for (size_t i = 0; i < this->primitives.size(); ++i) {
+    const auto& p = this->primitives[i];
+    const int count = p.type == PrimitiveType::TRIANGLE ? 3 : 2;
+    Eigen::Vector2f min = p.v[0].head<2>(), max = min;
+    for (int k = 1; k < count; ++k) {
+      min = min.cwiseMin(p.v[k].head<2>());
+      max = max.cwiseMax(p.v[k].head<2>());
+    }
+    const float margin = p.type == PrimitiveType::TRIANGLE ? 1.0f : p.size / 2 + 1.0f;
+    const int tx0 = std::max(0, static_cast<int>(std::floor((min.x() - margin) / TILE_SIZE)));
+    const int ty0 = std::max(0, static_cast<int>(std::floor((min.y() - margin) / TILE_SIZE)));
+    const int tx1 = std::min(tiles_x - 1, static_cast<int>(std::floor((max.x() + margin) / TILE_SIZE)));
+    const int ty1 = std::min(tiles_y - 1, static_cast<int>(std::floor((max.y() + margin) / TILE_SIZE)));
+    for (int ty = ty0; ty <= ty1; ++ty) {
+      for (int tx = tx0; tx <= tx1; ++tx) {
+        bins[ty * tiles_x + tx].push_back(i);
+      }
+    }
+  }
+
+  this->framebuffer.assign(4 * this->width * this->height, 0);
+  parallelizable_for(0, bins.size(), [&](size_t t) {
+    Tile tile;
+    tile.x0 = (t % tiles_x) * TILE_SIZE;
+    tile.y0 = (t / tiles_x) * TILE_SIZE;
+    tile.x1 = std::min<int>(tile.x0 + TILE_SIZE, this->width);
+    tile.y1 = std::min<int>(tile.y0 + TILE_SIZE, this->height);
+    this->rasterizeTile(tile, bins[t]);
+  });
+}
+
+void SoftwareView::rasterizeTile(Tile& tile, const std::vector<uint32_t>& primitive_indices)
+{
+  // Clear to the background, with a vertical gradient if the color scheme has one
+  const auto bgcol = ColorMap::getColor(*this->colorscheme, RenderColor::BACKGROUND_COLOR);
+  const auto bgstopcol = ColorMap::getColor(*this->colorscheme, RenderColor::BACKGROUND_STOP_COLOR);
+  tile.depth.assign(TILE_SIZE * TILE_SIZE, 1.0f);
+  tile.color.resize(4 * TILE_SIZE * TILE_SIZE);
+  for (int y = tile.y0; y < tile.y1; ++y) {
+    const float t = (y + 0.5f) / this->height;
+    const Eigen::Array4f bg = bgcol.array() * (1 - t) + bgstopcol.array() * t;
+    for (int x = tile.x0; x < tile.x1; ++x) {
+      Eigen::Map<Eigen::Array4f>(&tile.color[4 * ((y - tile.y0) * TILE_SIZE + x - tile.x0)]) = Eigen::Array4f(bg[0], bg[1], bg[2], 1.0f);
+    }
+  }
+
+  for (const auto index : primitive_indices) {
+    const Primitive& p = this->primitives[index];
+    switch (p.type) {
+    case PrimitiveType::TRIANGLE: rasterizeTriangle(p, tile); break;
+    case PrimitiveType::LINE: rasterizeLine(p, tile); break;
+    case PrimitiveType::POINT: rasterizePoint(p, tile); break;
+    }
+  }
+
+  for (int y = tile.y0; y < tile.y1; ++y) {
+    for (int x = tile.x0; x < tile.x1; ++x) {
+      const float *src = &tile.color[4 * ((y - tile.y0) * TILE_SIZE + x - tile.x0)];
+      uint8_t *dst = &this->framebuffer[4 * (y * this->width + x)];
+      for (int c = 0; c < 3; ++c) {
+        dst[c] = static_cast<uint8_t>(std::lround(std::clamp(src[c], 0.0f, 1.0f) * 255));
+      }
+      dst[3] = 255;
+    }
+  }
+}
+
+void SoftwareView::rasterizeTriangle(const Primitive& p, Tile& tile)
+{
+  const auto& a = p.v[0];
+  const auto& b = p.v[1];
+  const auto& c = p.v[2];
+  const float area = (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+  if (area == 0.0f) return;
+
+  // Barycentric coordinates of the pixel position, l = w / |area| with
+  // w = s * ((to.x - from.x) * (y - from.y) - (to.y - from.y) * (x - from.x)) for each edge. The
+  // endpoints are taken in a fixed order, so two triangles sharing an edge compute exactly the same
+  // product, with opposite signs s.
+  struct Edge {
+    float x, y, dx, dy, s;
+    // Top-left fill rule: a pixel center exactly on an edge belongs to the triangle for which
+    // it is a left edge (l grows with x) or a top edge (horizontal, l grows with y), so pixels
+    // on a shared edge are covered exactly once
+    float min;
+  };
+  const auto edge = [area](const Eigen::Vector3f& q, const Eigen::Vector3f& r) {
+    const bool swap = r.x() < q.x() || (r.x() == q.x() && r.y() < q.y());
+    const auto& from = swap ? r : q;
+    const auto& to = swap ? q : r;
+    const float s = (swap != (area < 0.0f)) ? -1.0f : 1.0f;
+    const float A = -(r.y() - q.y()) * area, B = (r.x() - q.x()) * area;
+    const bool top_left = A > 0.0f || (A == 0.0f && B > 0.0f);
+    return Edge{from.x(), from.y(), to.x() - from.x(), to.y() - from.y(), s,
+                top_left ? 0.0f : std::numeric_limits<float>::denorm_min()};
+  };
+  const Edge e0 = edge(b, c), e1 = edge(c, a), e2 = edge(a, b);
+  const float inv_area = 1.0f / std::abs(area);
+
+  const float xmin = std::max<float>(tile.x0, std::floor(std::min({a.x(), b.x(), c.x()})));
+  const float xmax = std::min<float>(tile.x1, std::ceil(std::max({a.x(), b.x(), c.x()})));
+  const int ymin = std::max<int>(tile.y0, std::floor(std::min({a.y(), b.y(), c.y()})));
+  const int ymax = std::min<int>(tile.y1, std::ceil(std::max({a.y(), b.y(), c.y()})));
+  if (xmin >= xmax) return;
+  // Start at a multiple of 4 pixels from the tile origin, so the 4-wide spans stay inside the tile buffers
+  const int xstart = tile.x0 + (static_cast<int>(xmin) - tile.x0) / 4 * 4;
+
+  const auto w = [](const Edge& e, const Eigen::Array4f& px, float py) {
+    return (e.s * (e.dx * (py - e.y) - e.dy * (px - e.x))).eval();
+  };
+
+  const Eigen::Array4f lane(0.5f, 1.5f, 2.5f, 3.5f);
+  for (int y = ymin; y < ymax; ++y) {
+    const float py = y + 0.5f;
+    float *depth_row = tile.depth.data() + (y - tile.y0) * TILE_SIZE;
+    float *color_row = tile.color.data() + 4 * (y - tile.y0) * TILE_SIZE;
+    for (int x = xstart; x < xmax; x += 4) {
+      const Eigen::Array4f px = lane + static_cast<float>(x);
+      const Eigen::Array4f w0 = w(e0, px, py), w1 = w(e1, px, py), w2 = w(e2, px, py);
+      const Eigen::Array4f z = (w0 * a.z() + w1 * b.z() + w2 * c.z()) * inv_area;
+      Eigen::Map<Eigen::Array4f> depth(depth_row + x - tile.x0);
+      const auto pass = (w0 >= e0.min && w1 >= e1.min && w2 >= e2.min && px < xmax && z < depth).eval();
+      if (!pass.any()) continue;
+      for (int k = 0; k < 4; ++k) {
+        if (!pass[k]) continue;
+        depth[k] = z[k];
+        blend(color_row + 4 * (x - tile.x0 + k), p.color);
+      }
+    }
+  }
+}
+
+void SoftwareView::rasterizeLine(const Primitive& p, Tile& tile)
+{
+  const auto& a = p.v[0];
+  const auto& b = p.v[1];
+  const Eigen::Vector3f d = b - a;
+  const bool x_major = std::abs(d.x()) >= std::abs(d.y());
+  const int major = x_major ? 0 : 1;
+  const int minor = 1 - major;
+  const float length = std::abs(d[major]);
+  if (length == 0.0f) return;
+
+  const int width = std::max(1, static_cast<int>(std::lround(p.size)));
+  const int tile_min[2] = {tile.x0, tile.y0};
+  const int tile_max[2] = {tile.x1, tile.y1};
+  // Pixels whose centers lie on [a, b) along the major axis
+  const int start = std::max<int>(tile_min[major], std::ceil(std::min(a[major], b[major]) - 0.5f));
+  const int end = std::min<int>(tile_max[major], std::ceil(std::max(a[major], b[major]) - 0.5f));
+  for (int i = start; i < end; ++i) {
+    const float t = (i + 0.5f - a[major]) / d[major];
+    // Stipple pattern counted in pixels from the first vertex
+    const int counter = static_cast<int>(t * length) / p.stipple_factor;
+    if (!((p.stipple >> (counter % 16)) & 1)) continue;
+    const float m = a[minor] + t * d[minor];
+    const float z = a.z() + t * d.z() - DEPTH_BIAS;
+    const int j0 = static_cast<int>(std::floor(m - (width - 1) / 2.0f));
+    for (int j = std::max(j0, tile_min[minor]); j < std::min(j0 + width, tile_max[minor]); ++j) {
+      const int x = x_major ? i : j;
+      const int y = x_major ? j : i;
+      const size_t offset = (y - tile.y0) * TILE_SIZE + x - tile.x0;
+      if (p.depth_test) {
+        if (!(z < tile.depth[offset])) continue;
+        tile.depth[offset] = z;
+      }
+      blend(&tile.color[4 * offset], p.color);
+    }
+  }
+}
+
+void SoftwareView::rasterizePoint(const Primitive& p, Tile& tile)
+{
+  const int size = std::max(1, static_cast<int>(std::lround(p.size)));
+  const int x0 = static_cast<int>(std::floor(p.v[0].x() - size / 2.0f + 0.5f));
+  const int y0 = static_cast<int>(std::floor(p.v[0].y() - size / 2.0f + 0.5f));
+  const float z = p.v[0].z() - DEPTH_BIAS;
+  for (int y = std::max(y0, tile.y0); y < std::min(y0 + size, tile.y1); ++y) {
+    for (int x = std::max(x0, tile.x0); x < std::min(x0 + size, tile.x1); ++x) {
+      const size_t offset = (y - tile.y0) * TILE_SIZE + x - tile.x0;
+      if (!(z < tile.depth[offset])) continue;
+      tile.depth[offset] = z;
+      blend(&tile.color[4 * offset], p.color);
+    }
+  }
+}
+
+bool SoftwareView::save(std::ostream& output) const
+{
+  if (this->framebuffer.empty()) return false;
+  return write_png(output, const_cast<uint8_t *>(this->framebuffer.data()), this->width, this->height);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+/* SoftwareView: Renders images on the CPU, without an OpenGL context.
+
+   This is the --render-backend=cpu counterpart of an OffscreenView showing a
+   CGALRenderer, and the only way to export images from NULLGL builds. It
+   mimics the fixed-function pipeline setup of GLView: the same camera
+   transforms, lighting, color scheme, edges, axes and crosshairs.
+
+   The image is split into tiles which are rasterized in parallel, four
+   pixels at a time.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+#include "geometry/linalg.h"
+#include "glview/Camera.h"
+#include "glview/ColorMap.h"
+
+class Geometry;
+class PolySet;
+class Polygon2d;
+
+class SoftwareView
+{
+public:
+  SoftwareView(uint32_t width, uint32_t height);
+
+  void resize(uint32_t width, uint32_t height) { this->width = width; this->height = height; }
+  void addGeometry(const std::shared_ptr<const Geometry>& geom);
+  [[nodiscard]] BoundingBox getBoundingBox() const;
+
+  void setCamera(const Camera& cam) { this->cam = cam; }
+  void setColorScheme(const ColorScheme& cs) { this->colorscheme = &cs; }
+  void setColorScheme(const std::string& cs);
+
+  void setShowAxes(bool enabled) { this->showaxes = enabled; }
+  void setShowEdges(bool enabled) { this->showedges = enabled; }
+  void setShowFaces(bool enabled) { this->showfaces = enabled; }
+  void setShowCrosshairs(bool enabled) { this->showcrosshairs = enabled; }
+
+  void paint();
+  bool save(std::ostream& output) const;
+  // RGBA, top row first
+  [[nodiscard]] const std::vector<uint8_t>& getFramebuffer() const { return this->framebuffer; }
+
+private:
+  struct Object {
+    std::shared_ptr<const PolySet> polyset; // tessellated faces
+    std::shared_ptr<const Polygon2d> polygon; // outlines of 2D objects
+    bool nef{false};
+  };
+
+  enum class PrimitiveType { TRIANGLE, LINE, POINT };
+
+  struct Primitive {
+    PrimitiveType type;
+    // Window coordinates (top row is y = 0) and normalized device depth
+    Eigen::Vector3f v[3];
+    Color4f color;
+    float size{1.0f}; // line width or point size, in pixels
+    uint16_t stipple{0xFFFF};
+    int stipple_factor{1};
+    bool depth_test{true};
+  };
+
+  struct Tile;
+
+  void addTriangle(const Eigen::Matrix4d& mvp, const Vector3d& p0, const Vector3d& p1, const Vector3d& p2, const Color4f& color);
+  void addLine(const Eigen::Matrix4d& mvp, const Eigen::Vector4d& p0, const Eigen::Vector4d& p1, const Color4f& color,
+               float width, bool depth_test = true, uint16_t stipple = 0xFFFF, int stipple_factor = 1);
+  void addPoint(const Eigen::Matrix4d& mvp, const Vector3d& p, const Color4f& color, float size);
+  [[nodiscard]] Eigen::Vector3f toWindow(const Eigen::Vector4d& clip) const;
+
+  void addObject(const Object& object, const Eigen::Matrix4d& projection, const Eigen::Matrix4d& modelview);
+  void addAxes(const Eigen::Matrix4d& mvp, const Color4f& col);
+  void addSmallaxes(const Color4f& col);
+  void addCrosshairs(const Eigen::Matrix4d& mvp, const Color4f& col);
+
+  void rasterizeTile(Tile& tile, const std::vector<uint32_t>& primitive_indices);
+  static void rasterizeTriangle(const Primitive& p, Tile& tile);
+  static void rasterizeLine(const Primitive& p, Tile& tile);
+  static void rasterizePoint(const Primitive& p, Tile& tile);
+
+  uint32_t width;
+  uint32_t height;
+  std::vector<Object> objects;
+  std::vector<Primitive> primitives;
+  std::vector<uint8_t> framebuffer;
+
+  const ColorScheme *colorscheme;
+  Camera cam;
+  bool showaxes{false};
+  bool showfaces{true};
+  bool showedges{false};
+  bool showcrosshairs{false};
+};
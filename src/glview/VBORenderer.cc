@@ -36,6 +36,7 @@
 #include <utility>
 #include <memory>
 #include <cstddef>
+#include <vector>
 
 namespace VBOUtils {
 
@@ -86,28 +87,31 @@ bool VBORenderer::getShaderColor(Renderer::ColorMode colormode, const Color4f& c
   return false;
 }
 
-size_t VBORenderer::getSurfaceBufferSize(const std::shared_ptr<CSGProducts>& products, bool unique_geometry) const
+size_t VBORenderer::getSurfaceBufferSize(const std::shared_ptr<CSGProducts>& products, bool unique_geometry,
+                                         const SurfacePrototypes *prototypes) const
 {
   size_t buffer_size = 0;
   if (unique_geometry) this->geom_visit_mark_.clear();
 
   for (const auto& product : products->products) {
     for (const auto& csgobj : product.intersections) {
-      buffer_size += getSurfaceBufferSize(csgobj);
+      buffer_size += getSurfaceBufferSize(csgobj, unique_geometry, prototypes);
     }
     for (const auto& csgobj : product.subtractions) {
-      buffer_size += getSurfaceBufferSize(csgobj);
+      buffer_size += getSurfaceBufferSize(csgobj, unique_geometry, prototypes);
     }
   }
   return buffer_size;
 }
 
-size_t VBORenderer::getSurfaceBufferSize(const CSGChainObject& csgobj, bool unique_geometry) const
+size_t VBORenderer::getSurfaceBufferSize(const CSGChainObject& csgobj, bool unique_geometry,
+                                         const SurfacePrototypes *prototypes) const
 {
   size_t buffer_size = 0;
   if (unique_geometry && this->geom_visit_mark_[std::make_pair(csgobj.leaf->polyset.get(), &csgobj.leaf->matrix)]++ > 0) return 0;
 
   if (csgobj.leaf->polyset) {
+    if (prototypes && findPrototype(*prototypes, *csgobj.leaf->polyset, csgobj.leaf->matrix)) return 0;
     buffer_size += getSurfaceBufferSize(*csgobj.leaf->polyset);
   }
   return buffer_size;
@@ -480,9 +484,13 @@ void VBORenderer::add_shader_pointers(VertexArray& vertex_array)
   vertex_array.states().emplace_back(std::move(ss));
 }
 
-void VBORenderer::add_color(VertexArray& vertex_array, const Color4f& color)
+void VBORenderer::add_color(VertexArray& vertex_array, const Color4f& color, const SurfacePrototype *instance_of)
 {
-  add_shader_pointers(vertex_array);
+  if (instance_of) {
+    vertex_array.states().emplace_back(instance_of->shader_pointers);
+  } else {
+    add_shader_pointers(vertex_array);
+  }
   const RendererUtils::ShaderInfo shader_info = getShader();
   std::shared_ptr<VertexState> color_state = std::make_shared<VBOShaderVertexState>(0, 0, vertex_array.verticesVBO(), vertex_array.elementsVBO());
   color_state->glBegin().emplace_back([shader_info, color]() {
@@ -491,3 +499,124 @@ void VBORenderer::add_color(VertexArray& vertex_array, const Color4f& color)
   });
   vertex_array.states().emplace_back(std::move(color_state));
 }
+
+std::vector<const PolySet *> VBORenderer::findInstancedPolySets(const std::vector<const CSGProducts *>& products)
+{
+  std::vector<const PolySet *> polysets;
+  std::unordered_map<const PolySet *, size_t> uses;
+  const auto count_use = [&](const CSGChainObject& csgobj) {
+    const auto *ps = csgobj.leaf->polyset.get();
+    // Instances are drawn in a single color, so per-face colors have to be written out
+    if (!ps || !ps->color_indices.empty()) return;
+    if (++uses[ps] == 2) polysets.push_back(ps);
+  };
+  for (const auto *csgproducts : products) {
+    for (const auto& product : csgproducts->products) {
+      for (const auto& csgobj : product.intersections) count_use(csgobj);
+      for (const auto& csgobj : product.subtractions) count_use(csgobj);
+    }
+  }
+  return polysets;
+}
+
+const SurfacePrototype *VBORenderer::findPrototype(const SurfacePrototypes& prototypes,
+                                                   const PolySet& ps, const Transform3d& m)
+{
+  if (prototypes.empty()) return nullptr;
+  // A mirroring transform would flip the winding of the shared triangles,
+  // create_surface() compensates for that when writing the vertices.
+  if (m.matrix().determinant() <= 0) return nullptr;
+  const auto it = prototypes.find(&ps);
+  return it == prototypes.end() ? nullptr : &it->second;
+}
+
+void VBORenderer::add_instance_transform(VertexState& vs, const Transform3d& m)
+{
+  std::array<GLdouble, 16> matrix;
+  Eigen::Map<Eigen::Matrix4d>(matrix.data()) = m.matrix();
+  vs.glBegin().emplace_back([matrix]() {
+    GL_TRACE0("glPushMatrix()");
+    GL_CHECKD(glPushMatrix());
+    GL_TRACE("glMultMatrixd(%p)", matrix.data());
+    GL_CHECKD(glMultMatrixd(matrix.data()));
+  });
+  vs.glEnd().emplace_back([]() {
+    GL_TRACE0("glPopMatrix()");
+    GL_CHECKD(glPopMatrix());
+  });
+}
+
+SurfacePrototypes VBORenderer::createSurfacePrototypes(const std::vector<const CSGProducts *>& products,
+                                                       std::vector<GLuint>& vbos,
+                                                       std::vector<std::shared_ptr<VertexState>>& states)
+{
+  SurfacePrototypes prototypes;
+  const auto polysets = findInstancedPolySets(products);
+  if (polysets.empty()) return prototypes;
+
+  GLuint vertices_vbo = 0, elements_vbo = 0;
+  glGenBuffers(1, &vertices_vbo);
+  vbos.push_back(vertices_vbo);
+  if (Feature::ExperimentalVxORenderersIndexing.is_enabled()) {
+    glGenBuffers(1, &elements_vbo);
+    vbos.push_back(elements_vbo);
+  }
+
+  std::vector<std::shared_ptr<VertexState>> prototype_states;
+  VertexArray vertex_array(std::make_unique<VertexStateFactory>(), prototype_states, vertices_vbo, elements_vbo);
+  vertex_array.addSurfaceData();
+  vertex_array.writeSurface();
+  if (getShader().progid != 0) {
+    vertex_array.add_shader_data();
+  }
+
+  size_t num_vertices = 0;
+  for (const auto *ps : polysets) {
+    num_vertices += getSurfaceBufferSize(*ps);
+  }
+  vertex_array.allocateBuffers(num_vertices);
+
+  for (const auto *ps : polysets) {
+    prototypes.emplace(ps, create_surface_prototype(*ps, vertex_array));
+  }
+  vertex_array.createInterleavedVBOs();
+
+  states.insert(states.end(), prototype_states.begin(), prototype_states.end());
+  return prototypes;
+}
+
+SurfacePrototype VBORenderer::create_surface_prototype(const PolySet& ps, VertexArray& vertex_array)
+{
+  const auto& states = vertex_array.states();
+  const auto first_state = states.size();
+  add_shader_pointers(vertex_array);
+  // The per-vertex color is a placeholder, instances set their own
+  create_surface(ps, vertex_array, RendererUtils::CSGMODE_NORMAL, Transform3d::Identity(),
+                 Color4f(1.0f, 1.0f, 1.0f, 1.0f), true);
+  assert(states.size() == first_state + 2);
+  return SurfacePrototype{states[first_state], states.back()};
+}
+
+std::shared_ptr<VertexState> VBORenderer::create_surface_instance(VertexArray& vertex_array,
+                                                                  const SurfacePrototype& prototype,
+                                                                  const Transform3d& m, const Color4f& color) const
+{
+  const auto& surface = *prototype.surface;
+  // Created through vertex_array, so renderers get their own VertexState type,
+  // but drawing from the prototype's buffers
+  std::shared_ptr<VertexState> vs = vertex_array.createVertexState(
+    surface.drawMode(), surface.drawSize(), surface.drawType(), surface.drawOffset(), surface.elementOffset());
+  vs->setVerticesVBO(surface.verticesVBO());
+  vs->setElementsVBO(surface.elementsVBO());
+  vs->glBegin() = prototype.surface->glBegin();
+  vs->glEnd() = prototype.surface->glEnd();
+  vs->glBegin().emplace_back([color]() {
+    GL_TRACE0("glDisableClientState(GL_COLOR_ARRAY)");
+    GL_CHECKD(glDisableClientState(GL_COLOR_ARRAY));
+    GL_TRACE("glColor4f(%f, %f, %f, %f)", color[0] % color[1] % color[2] % color[3]);
+    GL_CHECKD(glColor4f(color[0], color[1], color[2], color[3]));
+  });
+  add_instance_transform(*vs, m);
+  vertex_array.states().emplace_back(vs);
+  return vs;
+}
@@ -4,6 +4,7 @@
 #include <utility>
 #include <memory>
 #include <cstddef>
+#include <vector>
 #include "glview/Renderer.h"
 #include "glview/system-gl.h"
 #ifdef ENABLE_OPENCSG
@@ -28,13 +29,25 @@ public:
     : VertexState(0, 0, 0, draw_offset, element_offset, vertices_vbo, elements_vbo) {}
 };
 
+// A PolySet surface written once, untransformed, to a VertexArray of its own.
+// Leaves using the same PolySet draw it with their transform applied by GL,
+// instead of each baking the transform into a copy of the vertices.
+struct SurfacePrototype {
+  std::shared_ptr<VertexState> shader_pointers;
+  std::shared_ptr<VertexState> surface;
+};
+using SurfacePrototypes = std::unordered_map<const PolySet *, SurfacePrototype>;
+
 class VBORenderer : public Renderer
 {
 public:
   VBORenderer();
   virtual bool getShaderColor(Renderer::ColorMode colormode, const Color4f& col, Color4f& outcolor) const;
-  virtual size_t getSurfaceBufferSize(const std::shared_ptr<CSGProducts>& products, bool unique_geometry = false) const;
-  virtual size_t getSurfaceBufferSize(const CSGChainObject& csgobj, bool unique_geometry = false) const;
+  // Leaves drawn from one of the given prototypes take no space in the buffer
+  virtual size_t getSurfaceBufferSize(const std::shared_ptr<CSGProducts>& products, bool unique_geometry = false,
+                                      const SurfacePrototypes *prototypes = nullptr) const;
+  virtual size_t getSurfaceBufferSize(const CSGChainObject& csgobj, bool unique_geometry = false,
+                                      const SurfacePrototypes *prototypes = nullptr) const;
   virtual size_t getSurfaceBufferSize(const PolySet& polyset) const;
   virtual size_t getEdgeBufferSize(const PolySet& polyset) const;
   virtual size_t getEdgeBufferSize(const Polygon2d& polygon) const;
@@ -60,7 +73,28 @@ public:
                              size_t active_point_index = 0, size_t primitive_index = 0,
                              size_t shape_size = 0, bool outlines = false, bool mirror = false) const;
   void add_shader_pointers(VertexArray& vertex_array); // This could stay protected, were it not for VertexStateManager
-  void add_color(VertexArray& vertex_array, const Color4f& color);
+  // When instance_of is given, the shader attributes are read from the prototype's buffer
+  void add_color(VertexArray& vertex_array, const Color4f& color, const SurfacePrototype *instance_of = nullptr);
+
+  // Return the PolySets used by more than one leaf, in first use order
+  static std::vector<const PolySet *> findInstancedPolySets(const std::vector<const CSGProducts *>& products);
+  // Return the prototype a leaf with the given PolySet and transform is drawn from,
+  // or nullptr if its vertices have to be written out
+  static const SurfacePrototype *findPrototype(const SurfacePrototypes& prototypes,
+                                               const PolySet& ps, const Transform3d& m);
+  // Surround the draw call of vs with the given model transform
+  static void add_instance_transform(VertexState& vs, const Transform3d& m);
+
+  // Write each instanced PolySet of products once to a new VBO, and upload it.
+  // The created VBOs are appended to vbos. The prototype states are appended to
+  // states, which has to outlive any instance drawn from them.
+  SurfacePrototypes createSurfacePrototypes(const std::vector<const CSGProducts *>& products,
+                                            std::vector<GLuint>& vbos,
+                                            std::vector<std::shared_ptr<VertexState>>& states);
+  SurfacePrototype create_surface_prototype(const PolySet& ps, VertexArray& vertex_array);
+  // Add a state drawing the prototype with transform m and the given color
+  std::shared_ptr<VertexState> create_surface_instance(VertexArray& vertex_array, const SurfacePrototype& prototype,
+                                                       const Transform3d& m, const Color4f& color) const;
 
 protected:
   void add_shader_data(VertexArray& vertex_array);
@@ -1,5 +1,7 @@
 #include "glview/VertexArray.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <cassert>
 #include <array>
@@ -12,6 +14,75 @@
 
 void addAttributeValues(IAttributeData&) {}
 
+uint32_t ElementsMap::hashRecord(const GLbyte *record, size_t stride)
+{
+  // Mix the record 8 bytes at a time; vertex records are a few dozen bytes
+  uint64_t h = stride;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= stride; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, record + i, sizeof(word));
+    h = (h ^ word) * 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 29;
+  }
+  if (i < stride) {
+    uint64_t word = 0;
+    std::memcpy(&word, record + i, stride - i);
+    h = (h ^ word) * 0x9e3779b97f4a7c15ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return static_cast<uint32_t>(h);
+}
+
+GLuint ElementsMap::lookup(const GLbyte *record, size_t stride, bool& inserted)
+{
+  // All records in one map share the same layout
+  assert(size_ == 0 || stride == stride_);
+  stride_ = stride;
+  // Keep the load factor at or below 1/2
+  if ((size_ + 1) * 2 > table_.size()) rehash(std::max<size_t>(16, table_.size() * 2));
+
+  const uint32_t hash = hashRecord(record, stride);
+  const size_t mask = table_.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    Slot& slot = table_[i];
+    if (slot.index == EMPTY_SLOT) {
+      slot.index = static_cast<GLuint>(size_++);
+      slot.hash = hash;
+      records_.insert(records_.end(), record, record + stride);
+      inserted = true;
+      return slot.index;
+    }
+    if (slot.hash == hash && std::memcmp(records_.data() + slot.index * stride, record, stride) == 0) {
+      inserted = false;
+      return slot.index;
+    }
+  }
+}
+
+void ElementsMap::rehash(size_t num_slots)
+{
+  std::vector<Slot> old(num_slots, Slot{EMPTY_SLOT, 0});
+  old.swap(table_);
+  const size_t mask = num_slots - 1;
+  for (const auto& slot : old) {
+    if (slot.index == EMPTY_SLOT) continue;
+    size_t i = slot.hash & mask;
+    while (table_[i].index != EMPTY_SLOT) i = (i + 1) & mask;
+    table_[i] = slot;
+  }
+}
+
+void ElementsMap::clear()
+{
+  // Keep the allocations around, the map is reused for every surface
+  records_.clear();
+  std::fill(table_.begin(), table_.end(), Slot{EMPTY_SLOT, 0});
+  size_ = 0;
+}
+
 void VertexData::getLastVertex(std::vector<GLbyte>& interleaved_buffer) const
 {
   GLbyte *dst_start = interleaved_buffer.data();
@@ -71,47 +142,29 @@ void VertexArray::createVertex(const std::array<Vector3d, 3>& points,
   }
 
   if (useElements()) {
-    std::vector<GLbyte> interleaved_vertex;
-    interleaved_vertex.resize(data()->stride());
-    data()->getLastVertex(interleaved_vertex);
-    std::pair<ElementsMap::iterator, bool> entry;
-    entry.first = elements_map_.find(interleaved_vertex);
-    if (entry.first == elements_map_.end()) {
+    const size_t stride = data()->stride();
+    last_vertex_.resize(stride);
+    data()->getLastVertex(last_vertex_);
+    bool inserted = false;
+    const GLuint index = elements_map_.lookup(last_vertex_.data(), stride, inserted);
+    if (inserted) {
       // append vertex data if this is a new element
       if (vertices_size_) {
         if (interleaved_buffer_.size()) {
-          memcpy(interleaved_buffer_.data() + vertices_offset_, interleaved_vertex.data(), interleaved_vertex.size());
+          memcpy(interleaved_buffer_.data() + vertices_offset_, last_vertex_.data(), stride);
         } else {
-          GL_TRACE("glBufferSubData(GL_ARRAY_BUFFER, %d, %d, %p)", vertices_offset_ % interleaved_vertex.size() % interleaved_vertex.data());
-          GL_CHECKD(glBufferSubData(GL_ARRAY_BUFFER, vertices_offset_, interleaved_vertex.size(), interleaved_vertex.data()));
+          GL_TRACE("glBufferSubData(GL_ARRAY_BUFFER, %d, %d, %p)", vertices_offset_ % stride % last_vertex_.data());
+          GL_CHECKD(glBufferSubData(GL_ARRAY_BUFFER, vertices_offset_, stride, last_vertex_.data()));
         }
         data()->clear();
       }
-      vertices_offset_ += interleaved_vertex.size();
-      entry = elements_map_.emplace(interleaved_vertex, elements_map_.size());
+      vertices_offset_ += stride;
     } else {
       data()->remove();
-#if 0
-      if (OpenSCAD::debug != "") {
-        // in debug, check for bad hash matches
-        size_t i = 0;
-        if (interleaved_vertex.size() != entry.first->first.size()) {
-          PRINTDB("vertex index = %d", entry.first->second);
-          assert(false && "VBORenderer invalid vertex match size!!!");
-        }
-        for (const auto& b : interleaved_vertex) {
-          if (b != entry.first->first[i]) {
-            PRINTDB("vertex index = %d", entry.first->second);
-            assert(false && "VBORenderer invalid vertex value hash match!!!");
-          }
-          i++;
-        }
-      }
-#endif // 0
     }
 
     // append element data
-    addAttributeValues(*elementsData(), entry.first->second);
+    addAttributeValues(*elementsData(), index);
     elements_offset_ += elementsData()->sizeofAttribute();
   } else { // !useElements()
     if (!vertices_size_) {
@@ -144,11 +197,9 @@ void VertexArray::createInterleavedVBOs()
   size_t total_size = this->sizeInBytes();
   // If VertexArray is not empty, and initial size is zero
   if (!vertices_size_ && total_size) {
-    GL_TRACE("glBindBuffer(GL_ARRAY_BUFFER, %d)", vertices_vbo_);
-    GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_));
-    GL_TRACE("glBufferData(GL_ARRAY_BUFFER, %d, %p, GL_STATIC_DRAW)", total_size % (void *)nullptr);
-    GL_CHECKD(glBufferData(GL_ARRAY_BUFFER, total_size, nullptr, GL_STATIC_DRAW));
-
+    // Interleave on the CPU and upload once, instead of issuing a
+    // glBufferSubData() per vertex attribute
+    std::vector<GLbyte> interleaved(total_size);
     size_t dst_start = 0;
     for (const auto& vertex_data : vertices_) {
       // All attribute vectors need to be the same size to interleave
@@ -168,9 +219,8 @@ void VertexArray::createInterleavedVBOs()
           }
           last_size = data->size() / data->count();
           for (size_t i = 0; i < last_size; ++i) {
-	    // This path is chosen in vertex-object-renderers non-direct mode
-            GL_TRACE("A glBufferSubData(GL_ARRAY_BUFFER, %p, %d, %p)", (void *)dst % size % (void *)src);
-            GL_CHECKD(glBufferSubData(GL_ARRAY_BUFFER, dst, size, src));
+            // This path is chosen in vertex-object-renderers non-direct mode
+            std::memcpy(interleaved.data() + dst, src, size);
             src += size;
             dst += stride;
           }
@@ -181,6 +231,10 @@ void VertexArray::createInterleavedVBOs()
       dst_start = vertex_data->sizeInBytes();
     }
 
+    GL_TRACE("glBindBuffer(GL_ARRAY_BUFFER, %d)", vertices_vbo_);
+    GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_));
+    GL_TRACE("glBufferData(GL_ARRAY_BUFFER, %d, %p, GL_STATIC_DRAW)", total_size % (void *)interleaved.data());
+    GL_CHECKD(glBufferData(GL_ARRAY_BUFFER, total_size, interleaved.data(), GL_STATIC_DRAW));
     GL_TRACE0("glBindBuffer(GL_ARRAY_BUFFER, 0)");
     GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, 0));
   } else if (vertices_size_ && interleaved_buffer_.size()) {
@@ -196,10 +250,9 @@ void VertexArray::createInterleavedVBOs()
   if (useElements()) {
     GL_TRACE("glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, %d)", elements_vbo_);
     GL_CHECKD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements_vbo_));
-    if (elements_size_ == 0) {
-      GL_TRACE("glBufferData(GL_ELEMENT_ARRAY_BUFFER, %d, %p, GL_STATIC_DRAW)", elements_.sizeInBytes() % (void *)nullptr);
-      GL_CHECKD(glBufferData(GL_ELEMENT_ARRAY_BUFFER, elements_.sizeInBytes(), nullptr, GL_STATIC_DRAW));
-    }
+    const size_t elements_size = elements_size_ ? elements_size_ : elements_.sizeInBytes();
+    GL_TRACE("glBufferData(GL_ELEMENT_ARRAY_BUFFER, %d, %p, GL_STATIC_DRAW)", elements_size % (void *)nullptr);
+    GL_CHECKD(glBufferData(GL_ELEMENT_ARRAY_BUFFER, elements_size, nullptr, GL_STATIC_DRAW));
     size_t last_size = 0;
     for (const auto& e : elements_.attributes()) {
       GL_TRACE("glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, %d, %d, %p)", last_size % e->sizeInBytes() % (void *)e->toBytes());
@@ -288,15 +341,13 @@ void VertexArray::addAttributePointers(size_t start_offset)
   }
 }
 
-// Allocates GPU memory for vertices (and elements if enabled)
-// for holding the given number of vertices.
+// Allocates the CPU-side buffers for vertices (and elements if enabled)
+// for holding the given number of vertices. No GL calls are made here; the
+// GPU buffers are created from them in createInterleavedVBOs(), so several
+// VertexArrays can be filled concurrently before uploading.
 void VertexArray::allocateBuffers(size_t num_vertices) {
   size_t vertices_size = num_vertices * stride();
   setVerticesSize(vertices_size);
-  GL_TRACE("glBindBuffer(GL_ARRAY_BUFFER, %d)", vertices_vbo_);
-  GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, vertices_vbo_));
-  GL_TRACE("glBufferData(GL_ARRAY_BUFFER, %d, %p, GL_STATIC_DRAW)", vertices_size % (void *)nullptr);
-  GL_CHECKD(glBufferData(GL_ARRAY_BUFFER, vertices_size, nullptr, GL_STATIC_DRAW));
   if (Feature::ExperimentalVxORenderersIndexing.is_enabled()) {
     // Use smallest possible index data type
     if (num_vertices <= 0xff) {
@@ -309,10 +360,6 @@ void VertexArray::allocateBuffers(size_t num_vertices) {
     // FIXME: How do we know how much to allocate?
     size_t elements_size = num_vertices * elements_.stride();
     setElementsSize(elements_size);
-    GL_TRACE("glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, %d)", elements_vbo_);
-    GL_CHECKD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements_vbo_));
-    GL_TRACE("glBufferData(GL_ELEMENT_ARRAY_BUFFER, %d, %p, GL_STATIC_DRAW)", elements_size % (void *)nullptr);
-    GL_CHECKD(glBufferData(GL_ELEMENT_ARRAY_BUFFER, elements_size, nullptr, GL_STATIC_DRAW));
   }
 }
 
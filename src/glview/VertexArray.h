@@ -4,8 +4,7 @@
 #include <functional>
 #include <memory>
 #include <cstddef>
-#include <unordered_map>
-#include <boost/functional/hash.hpp>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -15,17 +14,35 @@
 #include "Feature.h"
 #include "glview/VertexState.h"
 
-// Hash function for opengl vertex data.
-template <typename T>
-struct vertex_hash {
-  std::size_t operator()(T const& vertex) const {
-    size_t seed = 0;
-    for (size_t i = 0; i < vertex.size(); ++i) boost::hash_combine(seed, vertex.data()[i]);
-    return seed;
-  }
-};
+// Maps interleaved vertex records of a fixed stride to element indices.
+// Records are kept back to back in one buffer and found through an open
+// addressing (linear probing) table, so looking up a vertex neither
+// allocates nor builds a key object.
+class ElementsMap
+{
+public:
+  // Return the element index of the record, adding it if it is new.
+  // inserted is set to whether the record was added.
+  GLuint lookup(const GLbyte *record, size_t stride, bool& inserted);
+  void clear();
+  [[nodiscard]] size_t size() const { return size_; }
+  [[nodiscard]] bool empty() const { return size_ == 0; }
 
-using ElementsMap = std::unordered_map<std::vector<GLbyte>, GLuint, vertex_hash<std::vector<GLbyte>>>;
+private:
+  struct Slot {
+    GLuint index;
+    uint32_t hash;
+  };
+  static constexpr GLuint EMPTY_SLOT = ~GLuint(0);
+
+  static uint32_t hashRecord(const GLbyte *record, size_t stride);
+  void rehash(size_t num_slots);
+
+  std::vector<GLbyte> records_;
+  std::vector<Slot> table_;
+  size_t stride_{0};
+  size_t size_{0};
+};
 
 // Interface class for basic attribute data that will be loaded into VBO
 class IAttributeData
@@ -357,5 +374,7 @@ private:
 
   VertexData elements_;
   ElementsMap elements_map_;
+  // Scratch space for the interleaved vertex being looked up
+  std::vector<GLbyte> last_vertex_;
 
 };
@@ -37,9 +37,12 @@
 #endif
 
 #include "Feature.h"
+#include "geometry/ConversionCache.h"
 #include "geometry/PolySet.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/PolySetUtils.h"
 #include "utils/printutils.h"
+#include "utils/parallel.h"
 
 #include "glview/cgal/CGALRenderUtils.h"
 #ifdef ENABLE_CGAL
@@ -54,8 +57,53 @@
 
 // #include "gui/Preferences.h"
 
+namespace {
+
+#ifdef ENABLE_CGAL
+// Holds the converted vertices, edges and facets only; it is never drawn
+// itself, but copied into a CGAL_OGL_VBOPolyhedron.
+class ConvertedPolyhedron : public CGAL::OGL::Polyhedron
+{
+public:
+  void draw(bool /*showedges*/) const override {}
+};
+#endif
+
+// Render data is kept in the ConversionCache, so a new CGALRenderer for the
+// same cached geometry, or a color scheme change, doesn't redo the conversion.
+std::shared_ptr<const PolySet> getRenderPolySet(const std::shared_ptr<const Geometry>& geom)
+{
+  return std::static_pointer_cast<const PolySet>(ConversionCache::instance()->get(
+    geom, "render-polyset", [&geom]() -> std::shared_ptr<const Geometry> {
+#ifdef ENABLE_MANIFOLD
+    if (const auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
+      return mani->toPolySet();
+    }
+#endif
+    // We need to tessellate here, in case the generated PolySet contains
+    // concave polygons See
+    // tests/data/scad/3D/features/polyhedron-concave-test.scad
+    return PolySetUtils::tessellate_faces(dynamic_cast<const PolySet&>(*geom));
+  }));
+}
+
+}  // namespace
+
 CGALRenderer::CGALRenderer(const std::shared_ptr<const class Geometry> &geom) {
-  this->addGeometry(geom);
+  std::vector<std::shared_ptr<const Geometry>> polyset_sources;
+  this->addGeometry(geom, polyset_sources);
+
+  // Converting the geometries to something renderable doesn't need GL, so
+  // independent geometries are converted in parallel
+  this->polysets.resize(polyset_sources.size());
+  parallelizable_for(0, polyset_sources.size(), [&](size_t i) {
+    this->polysets[i] = getRenderPolySet(polyset_sources[i]);
+  });
+  parallelizable_for(0, this->polygons.size(), [&](size_t i) {
+    auto& [polygon, polyset] = this->polygons[i];
+    polyset = std::shared_ptr<const PolySet>(polygon->tessellate());
+  });
+
   PRINTD("CGALRenderer::CGALRenderer() -> createPolyhedrons()");
 #ifdef ENABLE_CGAL
   if (!this->nefPolyhedrons.empty() && this->polyhedrons.empty())
@@ -63,22 +111,24 @@ CGALRenderer::CGALRenderer(const std::shared_ptr<const class Geometry> &geom) {
 #endif
 }
 
-void CGALRenderer::addGeometry(const std::shared_ptr<const Geometry> &geom) {
+// Collects the geometries to render. PolySets and Manifolds are added to
+// polyset_sources, and Polygon2ds to polygons, to be converted afterwards.
+void CGALRenderer::addGeometry(const std::shared_ptr<const Geometry> &geom,
+                               std::vector<std::shared_ptr<const Geometry>> &polyset_sources) {
   if (const auto geomlist =
           std::dynamic_pointer_cast<const GeometryList>(geom)) {
     for (const auto &item : geomlist->getChildren()) {
-      this->addGeometry(item.second);
+      this->addGeometry(item.second, polyset_sources);
     }
   } else if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     assert(ps->getDimension() == 3);
-    // We need to tessellate here, in case the generated PolySet contains
-    // concave polygons See
-    // tests/data/scad/3D/features/polyhedron-concave-test.scad
-    this->polysets.push_back(PolySetUtils::tessellate_faces(*ps));
+    polyset_sources.push_back(ps);
+  } else if (const auto instance =
+                 std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    this->addGeometry(InstancedGeometry::resolve(instance), polyset_sources);
   } else if (const auto poly =
                  std::dynamic_pointer_cast<const Polygon2d>(geom)) {
-    this->polygons.emplace_back(
-        poly, std::shared_ptr<const PolySet>(poly->tessellate()));
+    this->polygons.emplace_back(poly, nullptr);
 #ifdef ENABLE_CGAL
   } else if (const auto new_N =
                  std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
@@ -90,7 +140,7 @@ void CGALRenderer::addGeometry(const std::shared_ptr<const Geometry> &geom) {
 #ifdef ENABLE_MANIFOLD
   } else if (const auto mani =
                  std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
-    this->polysets.push_back(mani->toPolySet());
+    polyset_sources.push_back(mani);
 #endif
   } else {
     assert(false && "unsupported geom in CGALRenderer");
@@ -110,10 +160,29 @@ CGALRenderer::~CGALRenderer() {
 void CGALRenderer::createPolyhedrons() {
   PRINTD("createPolyhedrons");
   this->polyhedrons.clear();
-  for (const auto &N : this->nefPolyhedrons) {
+
+  // The conversion from exact to double coordinates is independent of colors
+  // and GL, so it is done in parallel and cached with the Nef polyhedron.
+  std::vector<std::shared_ptr<const CGAL::OGL::Polyhedron>> converted(this->nefPolyhedrons.size());
+  parallelizable_for(0, this->nefPolyhedrons.size(), [&](size_t i) {
+    const auto& N = this->nefPolyhedrons[i];
+    converted[i] = ConversionCache::instance()->getData<CGAL::OGL::Polyhedron>(
+      N, "render-polyhedron",
+      [&N]() -> std::shared_ptr<const CGAL::OGL::Polyhedron> {
+      auto P = std::make_shared<ConvertedPolyhedron>();
+      CGAL::OGL::Nef3_Converter<CGAL_Nef_polyhedron3>::convert_to_OGLPolyhedron(*N->p3, P.get());
+      return P;
+    },
+      [](const CGAL::OGL::Polyhedron& P) { return P.memsize(); });
+  });
+
+  for (const auto &P : converted) {
     auto p = new CGAL_OGL_VBOPolyhedron(*colorscheme_);
-    CGAL::OGL::Nef3_Converter<CGAL_Nef_polyhedron3>::convert_to_OGLPolyhedron(
-        *N->p3, p);
+    // Only the geometry is copied; GL state and display settings are p's own
+    for (const auto& v : P->vertices()) p->push_back(v, v.mark());
+    for (const auto& e : P->edges()) p->push_back(e, e.mark());
+    for (const auto& f : P->halffacets()) p->push_back(f);
+    p->bbox() = P->bbox();
     // CGAL_NEF3_MARKED_FACET_COLOR <- CGAL_FACE_BACK_COLOR
     // CGAL_NEF3_UNMARKED_FACET_COLOR <- CGAL_FACE_FRONT_COLOR
     p->init();
@@ -23,7 +23,8 @@ public:
   std::vector<SelectedObject> findModelObject(Vector3d near_pt, Vector3d far_pt, int mouse_x, int mouse_y, double tolerance) override;
 
 private:
-  void addGeometry(const std::shared_ptr<const class Geometry>& geom);
+  void addGeometry(const std::shared_ptr<const class Geometry>& geom,
+                   std::vector<std::shared_ptr<const class Geometry>>& polyset_sources);
 #ifdef ENABLE_CGAL
   const std::vector<std::shared_ptr<class CGAL_OGL_Polyhedron>>& getPolyhedrons() const { return this->polyhedrons; }
   void createPolyhedrons();
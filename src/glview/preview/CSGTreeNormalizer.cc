@@ -108,6 +108,7 @@ cont_right:;
 
   // FIXME: Do we need to take into account any transformation of item here?
   node = collapse_null_terms(node);
+  if (node && !this->aborted) prune_term(node);
 
   if (this->aborted) {
     if (node) node = cleanup_term(node);
@@ -162,11 +163,34 @@ std::shared_ptr<CSGNode> CSGTreeNormalizer::collapse_null_terms(const std::share
   return node;
 }
 
+/*!
+   Geometric pruning as done by CSGOperation::createCSGNode(), reapplied to an
+   existing term. Normalizing a subtree can shrink its bounding box, so a term
+   which couldn't be pruned when the tree was built may be prunable now.
+   Pruning it here keeps it from being multiplied out by the rules below.
+   Otherwise, refreshes the term's bounding box from its current children.
+   Returns true if the term was replaced.
+ */
+bool CSGTreeNormalizer::prune_term(std::shared_ptr<CSGNode>& node)
+{
+  std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
+  if (!op || !op->left() || !op->right()) return false;
+  if (op->getType() != OpenSCADOperator::UNION &&
+      op->left()->getBoundingBox().intersection(op->right()->getBoundingBox()).isNull()) {
+    if (op->getType() == OpenSCADOperator::INTERSECTION) node = CSGNode::createEmptySet();
+    else node = op->left(); // Prune the negative component
+    return true;
+  }
+  op->initBoundingBox();
+  return false;
+}
+
 bool CSGTreeNormalizer::match_and_replace(std::shared_ptr<CSGNode>& node)
 {
   std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
   if (!op) return false;
   if (op->getType() == OpenSCADOperator::UNION) return false;
+  if (prune_term(node)) return true;
 
   // Part A: The 'x . (y . z)' expressions
 
@@ -13,6 +13,7 @@ public:
 private:
   std::shared_ptr<CSGNode> normalizePass(std::shared_ptr<CSGNode> term);
   bool match_and_replace(std::shared_ptr<class CSGNode>& term);
+  bool prune_term(std::shared_ptr<CSGNode>& term);
   std::shared_ptr<CSGNode> collapse_null_terms(const std::shared_ptr<CSGNode>& term);
   std::shared_ptr<CSGNode> cleanup_term(std::shared_ptr<CSGNode>& t);
   [[nodiscard]] unsigned int count(const std::shared_ptr<CSGNode>& term) const;
@@ -30,6 +30,7 @@
 
 #include "Feature.h"
 #include "geometry/PolySet.h"
+#include "utils/parallel.h"
 #include <cassert>
 #include <memory>
 #include <memory.h>
@@ -61,10 +62,11 @@ private:
 
 // Primitive for drawing using OpenCSG
 // Makes a copy of the given VertexState enabling just unlit/uncolored vertex
-// rendering
+// rendering. Instances of a shared surface also need their transform.
 OpenCSGVBOPrim *createVBOPrimitive(
     const std::shared_ptr<OpenCSGVertexState> &vertex_state,
-    const OpenCSG::Operation operation, const unsigned int convexity) {
+    const OpenCSG::Operation operation, const unsigned int convexity,
+    const Transform3d *instance_transform = nullptr) {
   std::unique_ptr<VertexState> opencsg_vs = std::make_unique<VertexState>(
       vertex_state->drawMode(), vertex_state->drawSize(),
       vertex_state->drawType(), vertex_state->drawOffset(),
@@ -78,6 +80,9 @@ OpenCSGVBOPrim *createVBOPrimitive(
   opencsg_vs->glEnd().insert(opencsg_vs->glEnd().begin(),
                              vertex_state->glEnd().begin(),
                              vertex_state->glEnd().begin() + 1);
+  if (instance_transform) {
+    VBORenderer::add_instance_transform(*opencsg_vs, *instance_transform);
+  }
 
   return new OpenCSGVBOPrim(operation, convexity, std::move(opencsg_vs));
 }
@@ -165,7 +170,8 @@ void OpenCSGRenderer::draw(bool /*showfaces*/, bool showedges,
 }
 
 // Turn the CSGProducts into VBOs
-// Will create one (temporary) VertexArray and one VBO(+EBO) per product
+// Will create one (temporary) VertexArray and one VBO(+EBO) per product.
+// The vertex data is generated a batch of products at a time, then uploaded.
 // The VBO will be utilized to render multiple objects with correct state
 // management. In the future, we could use a VBO per primitive and potentially
 // reuse VBOs, but that requires some more careful state management.
@@ -194,195 +200,244 @@ void OpenCSGRenderer::createCSGVBOProducts(
   }
 
 #ifdef ENABLE_OPENCSG
-  for (auto i = 0; i < products.products.size(); ++i) {
-    const auto& product = products.products[i];
-    const auto vertices_vbo = vertices_vbos[i];
-    const auto elements_vbo = elements_vbos[i];
-
-    Color4f last_color;
-    std::vector<OpenCSG::Primitive *> primitives;
-    std::unique_ptr<std::vector<std::shared_ptr<VertexState>>> vertex_states =
-        std::make_unique<std::vector<std::shared_ptr<VertexState>>>();
-    VertexArray vertex_array(std::make_unique<OpenCSGVertexStateFactory>(),
-                             *(vertex_states.get()), vertices_vbo,
-                             elements_vbo);
-    vertex_array.addSurfaceData();
-    vertex_array.writeSurface();
-    if (getShader().progid != 0) {
-      vertex_array.add_shader_data();
-    } else {
-      LOG("Warning: Shader not available");
-    }
+  const auto num_products = products.products.size();
+  const bool has_shader = getShader().progid != 0;
+  if (num_products && !has_shader) {
+    LOG("Warning: Shader not available");
+  }
 
-    size_t num_vertices = 0;
+  SurfacePrototypes prototypes;
+  if (Feature::ExperimentalVxORenderersInstancing.is_enabled()) {
+    prototypes = createSurfacePrototypes({&products}, all_vbos_, instance_states_);
+  }
+
+  std::vector<size_t> num_vertices(num_products, 0);
+  for (size_t i = 0; i < num_products; ++i) {
+    const auto& product = products.products[i];
     for (const auto &csgobj : product.intersections) {
-      if (csgobj.leaf->polyset) {
-        num_vertices += getSurfaceBufferSize(csgobj);
-      }
+      if (csgobj.leaf->polyset) num_vertices[i] += getSurfaceBufferSize(csgobj, false, &prototypes);
     }
     for (const auto &csgobj : product.subtractions) {
-      if (csgobj.leaf->polyset) {
-        num_vertices += getSurfaceBufferSize(csgobj);
+      if (csgobj.leaf->polyset) num_vertices[i] += getSurfaceBufferSize(csgobj, false, &prototypes);
+    }
+  }
+
+  // Vertex generation only writes to each product's own CPU-side buffers, so
+  // the products are built independently. The GL uploads happen afterwards,
+  // in product order, on this thread. Products are processed in batches of
+  // bounded size, so the CPU-side copy of a large model isn't held all at once.
+  constexpr size_t max_batch_vertices = 1 << 20;
+  std::vector<std::unique_ptr<std::vector<std::shared_ptr<VertexState>>>> product_states(num_products);
+  std::vector<std::unique_ptr<VertexArray>> vertex_arrays(num_products);
+  std::vector<std::vector<OpenCSG::Primitive *>> product_primitives(num_products);
+  for (size_t begin = 0, end = 0; begin < num_products; begin = end) {
+    size_t batch_vertices = num_vertices[end++];
+    while (end < num_products && batch_vertices + num_vertices[end] <= max_batch_vertices) {
+      batch_vertices += num_vertices[end++];
+    }
+
+    parallelizable_for(begin, end, [&](size_t i) {
+      product_states[i] = std::make_unique<std::vector<std::shared_ptr<VertexState>>>();
+      vertex_arrays[i] = std::make_unique<VertexArray>(std::make_unique<OpenCSGVertexStateFactory>(),
+                                                       *product_states[i], vertices_vbos[i], elements_vbos[i]);
+      createCSGVBOProduct(products.products[i], num_vertices[i], *vertex_arrays[i], *product_states[i],
+                          product_primitives[i], prototypes, has_shader, highlight_mode, background_mode);
+    });
+
+    for (size_t i = begin; i < end; ++i) {
+      if (Feature::ExperimentalVxORenderersIndexing.is_enabled()) {
+        GL_TRACE0("glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0)");
+        GL_CHECKD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
       }
+      GL_TRACE0("glBindBuffer(GL_ARRAY_BUFFER, 0)");
+      GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+      vertex_arrays[i]->createInterleavedVBOs();
+      vertex_arrays[i].reset();
+      vbo_vertex_products_.emplace_back(std::make_unique<OpenCSGVBOProduct>(
+          std::move(product_primitives[i]), std::move(product_states[i])));
     }
+  }
+#endif // ENABLE_OPENCSG
+}
 
-    vertex_array.allocateBuffers(num_vertices);
+// Fills the CPU-side buffers of vertex_array with the surfaces of a single
+// product, num_vertices in total, and collects its OpenCSG primitives. Makes no GL calls, so it is
+// safe to run for several products concurrently.
+void OpenCSGRenderer::createCSGVBOProduct(
+    const CSGProduct &product, size_t num_vertices, VertexArray &vertex_array,
+    std::vector<std::shared_ptr<VertexState>> &vertex_states,
+    std::vector<OpenCSG::Primitive *> &primitives,
+    const SurfacePrototypes &prototypes, bool has_shader,
+    bool highlight_mode, bool background_mode) {
+#ifdef ENABLE_OPENCSG
+  Color4f last_color;
+  vertex_array.addSurfaceData();
+  vertex_array.writeSurface();
+  if (has_shader) {
+    vertex_array.add_shader_data();
+  }
 
-    for (const auto &csgobj : product.intersections) {
-      if (csgobj.leaf->polyset) {
-        const Color4f &c = csgobj.leaf->color;
-        const auto csgmode = RendererUtils::getCsgMode(highlight_mode, background_mode);
-
-        ColorMode colormode = ColorMode::NONE;
-        bool override_color;
-        if (highlight_mode) {
-          colormode = ColorMode::HIGHLIGHT;
-          override_color = true;
-        } else if (background_mode) {
-          colormode = ColorMode::BACKGROUND;
-          override_color = true;
-        } else {
-          colormode = ColorMode::MATERIAL;
-          override_color = c.isValid();
-        }
+  vertex_array.allocateBuffers(num_vertices);
 
-        Color4f color;
-        if (getShaderColor(colormode, c, color)) {
-          last_color = color;
-        }
+  // Draw a leaf from its shared prototype if it has one, otherwise write its
+  // transformed vertices to this product's buffer
+  const auto add_surface = [&](const PolySet &ps, const SurfacePrototype *prototype,
+                               RendererUtils::CSGMode csgmode, const Transform3d &m,
+                               const Color4f &color, bool override_color) {
+    if (prototype) {
+      create_surface_instance(vertex_array, *prototype, m, color);
+    } else {
+      create_surface(ps, vertex_array, csgmode, m, color, override_color);
+    }
+  };
+
+  for (const auto &csgobj : product.intersections) {
+    if (csgobj.leaf->polyset) {
+      const Color4f &c = csgobj.leaf->color;
+      const auto csgmode = RendererUtils::getCsgMode(highlight_mode, background_mode);
+
+      ColorMode colormode = ColorMode::NONE;
+      bool override_color;
+      if (highlight_mode) {
+        colormode = ColorMode::HIGHLIGHT;
+        override_color = true;
+      } else if (background_mode) {
+        colormode = ColorMode::BACKGROUND;
+        override_color = true;
+      } else {
+        colormode = ColorMode::MATERIAL;
+        override_color = c.isValid();
+      }
 
-        add_color(vertex_array, last_color);
-
-        if (color[3] == 1.0f) {
-          // object is opaque, draw normally
-          create_surface(*csgobj.leaf->polyset, vertex_array, csgmode,
-                         csgobj.leaf->matrix, last_color, override_color);
-          const auto surface = std::dynamic_pointer_cast<OpenCSGVertexState>(
-            vertex_states->back());
-          if (surface != nullptr) {
-            surface->setCsgObjectIndex(csgobj.leaf->index);
-            primitives.emplace_back(
-                createVBOPrimitive(surface, OpenCSG::Intersection,
-                                   csgobj.leaf->polyset->getConvexity()));
-          }
-        } else {
-          // object is transparent, so draw rear faces first.  Issue #1496
-          std::shared_ptr<VertexState> cull = std::make_shared<VertexState>();
-          cull->glBegin().emplace_back([]() {
-            GL_TRACE0("glEnable(GL_CULL_FACE)"); glEnable(GL_CULL_FACE);
-            GL_TRACE0("glCullFace(GL_FRONT)"); glCullFace(GL_FRONT);
-          });
-          vertex_states->emplace_back(std::move(cull));
-
-          create_surface(*csgobj.leaf->polyset, vertex_array, csgmode,
-                         csgobj.leaf->matrix, last_color, override_color);
-          std::shared_ptr<OpenCSGVertexState> surface =
-              std::dynamic_pointer_cast<OpenCSGVertexState>(
-                  vertex_states->back());
-
-          if (surface != nullptr) {
-            surface->setCsgObjectIndex(csgobj.leaf->index);
-
-            primitives.emplace_back(
-                createVBOPrimitive(surface, OpenCSG::Intersection,
-                                   csgobj.leaf->polyset->getConvexity()));
-
-            cull = std::make_shared<VertexState>();
-            cull->glBegin().emplace_back([]() {
-              GL_TRACE0("glCullFace(GL_BACK)");
-              glCullFace(GL_BACK);
-            });
-            vertex_states->emplace_back(std::move(cull));
-
-            vertex_states->emplace_back(surface);
-
-            cull = std::make_shared<VertexState>();
-            cull->glEnd().emplace_back([]() {
-              GL_TRACE0("glDisable(GL_CULL_FACE)");
-              glDisable(GL_CULL_FACE);
-            });
-            vertex_states->emplace_back(std::move(cull));
-          } else {
-            assert(false && "Intersection surface state was nullptr");
-          }
-        }
+      Color4f color;
+      if (getShaderColor(colormode, c, color)) {
+        last_color = color;
       }
-    }
 
-    for (const auto &csgobj : product.subtractions) {
-      if (csgobj.leaf->polyset) {
-        const Color4f &c = csgobj.leaf->color;
-        const auto csgmode = RendererUtils::getCsgMode(highlight_mode, background_mode,
-                                         OpenSCADOperator::DIFFERENCE);
-
-        ColorMode colormode = ColorMode::NONE;
-        bool override_color;
-        if (highlight_mode) {
-          colormode = ColorMode::HIGHLIGHT;
-          override_color = true;
-        } else if (background_mode) {
-          colormode = ColorMode::BACKGROUND;
-          override_color = true;
-        } else {
-          colormode = ColorMode::CUTOUT;
-          override_color = true;
-        }
+      const auto& matrix = csgobj.leaf->matrix;
+      const auto *prototype = findPrototype(prototypes, *csgobj.leaf->polyset, matrix);
+      add_color(vertex_array, last_color, prototype);
 
-        Color4f color;
-        if (getShaderColor(colormode, c, color)) {
-          last_color = color;
+      if (color[3] == 1.0f) {
+        // object is opaque, draw normally
+        add_surface(*csgobj.leaf->polyset, prototype, csgmode, matrix, last_color, override_color);
+        const auto surface = std::dynamic_pointer_cast<OpenCSGVertexState>(
+          vertex_states.back());
+        if (surface != nullptr) {
+          surface->setCsgObjectIndex(csgobj.leaf->index);
+          primitives.emplace_back(
+              createVBOPrimitive(surface, OpenCSG::Intersection,
+                                 csgobj.leaf->polyset->getConvexity(),
+                                 prototype ? &matrix : nullptr));
         }
-
-        add_color(vertex_array, last_color);
-
-        // negative objects should only render rear faces
+      } else {
+        // object is transparent, so draw rear faces first.  Issue #1496
         std::shared_ptr<VertexState> cull = std::make_shared<VertexState>();
         cull->glBegin().emplace_back([]() {
-          GL_TRACE0("glEnable(GL_CULL_FACE)");
-          GL_CHECKD(glEnable(GL_CULL_FACE));
+          GL_TRACE0("glEnable(GL_CULL_FACE)"); glEnable(GL_CULL_FACE);
+          GL_TRACE0("glCullFace(GL_FRONT)"); glCullFace(GL_FRONT);
         });
-        cull->glBegin().emplace_back([]() {
-          GL_TRACE0("glCullFace(GL_FRONT)");
-          GL_CHECKD(glCullFace(GL_FRONT));
-        });
-        vertex_states->emplace_back(std::move(cull));
-        Transform3d tmp = csgobj.leaf->matrix;
-        if (csgobj.leaf->polyset->getDimension() == 2) {
-          // Scale 2D negative objects 10% in the Z direction to avoid z fighting
-          tmp *= Eigen::Scaling(1.0, 1.0, 1.1);
-        }
-        create_surface(*csgobj.leaf->polyset, vertex_array, csgmode, tmp,
-                       last_color, override_color);
-        const auto surface = std::dynamic_pointer_cast<OpenCSGVertexState>(
-          vertex_states->back());
+        vertex_states.emplace_back(std::move(cull));
+
+        add_surface(*csgobj.leaf->polyset, prototype, csgmode, matrix, last_color, override_color);
+        std::shared_ptr<OpenCSGVertexState> surface =
+            std::dynamic_pointer_cast<OpenCSGVertexState>(
+                vertex_states.back());
+
         if (surface != nullptr) {
           surface->setCsgObjectIndex(csgobj.leaf->index);
+
           primitives.emplace_back(
-              createVBOPrimitive(surface, OpenCSG::Subtraction,
-                                 csgobj.leaf->polyset->getConvexity()));
+              createVBOPrimitive(surface, OpenCSG::Intersection,
+                                 csgobj.leaf->polyset->getConvexity(),
+                                 prototype ? &matrix : nullptr));
+
+          cull = std::make_shared<VertexState>();
+          cull->glBegin().emplace_back([]() {
+            GL_TRACE0("glCullFace(GL_BACK)");
+            glCullFace(GL_BACK);
+          });
+          vertex_states.emplace_back(std::move(cull));
+
+          vertex_states.emplace_back(surface);
+
+          cull = std::make_shared<VertexState>();
+          cull->glEnd().emplace_back([]() {
+            GL_TRACE0("glDisable(GL_CULL_FACE)");
+            glDisable(GL_CULL_FACE);
+          });
+          vertex_states.emplace_back(std::move(cull));
         } else {
-          assert(false && "Subtraction surface state was nullptr");
+          assert(false && "Intersection surface state was nullptr");
         }
-
-        cull = std::make_shared<VertexState>();
-        cull->glEnd().emplace_back([]() {
-          GL_TRACE0("glDisable(GL_CULL_FACE)");
-          GL_CHECKD(glDisable(GL_CULL_FACE));
-        });
-        vertex_states->emplace_back(std::move(cull));
       }
     }
+  }
 
-    if (Feature::ExperimentalVxORenderersIndexing.is_enabled()) {
-      GL_TRACE0("glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0)");
-      GL_CHECKD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-    }
-    GL_TRACE0("glBindBuffer(GL_ARRAY_BUFFER, 0)");
-    GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, 0));
+  for (const auto &csgobj : product.subtractions) {
+    if (csgobj.leaf->polyset) {
+      const Color4f &c = csgobj.leaf->color;
+      const auto csgmode = RendererUtils::getCsgMode(highlight_mode, background_mode,
+                                       OpenSCADOperator::DIFFERENCE);
+
+      ColorMode colormode = ColorMode::NONE;
+      bool override_color;
+      if (highlight_mode) {
+        colormode = ColorMode::HIGHLIGHT;
+        override_color = true;
+      } else if (background_mode) {
+        colormode = ColorMode::BACKGROUND;
+        override_color = true;
+      } else {
+        colormode = ColorMode::CUTOUT;
+        override_color = true;
+      }
+
+      Color4f color;
+      if (getShaderColor(colormode, c, color)) {
+        last_color = color;
+      }
 
-    vertex_array.createInterleavedVBOs();
-    vbo_vertex_products_.emplace_back(std::make_unique<OpenCSGVBOProduct>(
-        std::move(primitives), std::move(vertex_states)));
+      const auto *prototype = findPrototype(prototypes, *csgobj.leaf->polyset, csgobj.leaf->matrix);
+      add_color(vertex_array, last_color, prototype);
+
+      // negative objects should only render rear faces
+      std::shared_ptr<VertexState> cull = std::make_shared<VertexState>();
+      cull->glBegin().emplace_back([]() {
+        GL_TRACE0("glEnable(GL_CULL_FACE)");
+        GL_CHECKD(glEnable(GL_CULL_FACE));
+      });
+      cull->glBegin().emplace_back([]() {
+        GL_TRACE0("glCullFace(GL_FRONT)");
+        GL_CHECKD(glCullFace(GL_FRONT));
+      });
+      vertex_states.emplace_back(std::move(cull));
+      Transform3d tmp = csgobj.leaf->matrix;
+      if (csgobj.leaf->polyset->getDimension() == 2) {
+        // Scale 2D negative objects 10% in the Z direction to avoid z fighting
+        tmp *= Eigen::Scaling(1.0, 1.0, 1.1);
+      }
+      add_surface(*csgobj.leaf->polyset, prototype, csgmode, tmp, last_color, override_color);
+      const auto surface = std::dynamic_pointer_cast<OpenCSGVertexState>(
+        vertex_states.back());
+      if (surface != nullptr) {
+        surface->setCsgObjectIndex(csgobj.leaf->index);
+        primitives.emplace_back(
+            createVBOPrimitive(surface, OpenCSG::Subtraction,
+                               csgobj.leaf->polyset->getConvexity(),
+                               prototype ? &tmp : nullptr));
+      } else {
+        assert(false && "Subtraction surface state was nullptr");
+      }
+
+      cull = std::make_shared<VertexState>();
+      cull->glEnd().emplace_back([]() {
+        GL_TRACE0("glDisable(GL_CULL_FACE)");
+        GL_CHECKD(glDisable(GL_CULL_FACE));
+      });
+      vertex_states.emplace_back(std::move(cull));
+    }
   }
 #endif // ENABLE_OPENCSG
 }
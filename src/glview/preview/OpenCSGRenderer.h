@@ -79,9 +79,16 @@ public:
   BoundingBox getBoundingBox() const override;
 private:
   void createCSGVBOProducts(const CSGProducts& products, const RendererUtils::ShaderInfo *shaderinfo, bool highlight_mode, bool background_mode);
+  void createCSGVBOProduct(const CSGProduct& product, size_t num_vertices, VertexArray& vertex_array,
+                           std::vector<std::shared_ptr<VertexState>>& vertex_states,
+                           std::vector<OpenCSG::Primitive *>& primitives,
+                           const SurfacePrototypes& prototypes, bool has_shader,
+                           bool highlight_mode, bool background_mode);
 
   std::vector<std::unique_ptr<OpenCSGVBOProduct>> vbo_vertex_products_;
   std::vector<GLuint> all_vbos_;
+  // Shared surfaces that instanced leaves of the products draw from
+  std::vector<std::shared_ptr<VertexState>> instance_states_;
   std::shared_ptr<CSGProducts> root_products_;
   std::shared_ptr<CSGProducts> highlights_products_;
   std::shared_ptr<CSGProducts> background_products_;
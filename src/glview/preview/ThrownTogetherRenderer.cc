@@ -84,6 +84,9 @@ ThrownTogetherRenderer::~ThrownTogetherRenderer()
   if (elements_vbo_) {
     glDeleteBuffers(1, &elements_vbo_);
   }
+  if (!instance_vbos_.empty()) {
+    glDeleteBuffers(instance_vbos_.size(), instance_vbos_.data());
+  }
 }
 
 void ThrownTogetherRenderer::prepare(bool /*showfaces*/, bool /*showedges*/, const RendererUtils::ShaderInfo * /*shaderinfo*/)
@@ -102,10 +105,18 @@ void ThrownTogetherRenderer::prepare(bool /*showfaces*/, bool /*showedges*/, con
       LOG("Warning: Shader not available");
     }
 
+    if (Feature::ExperimentalVxORenderersInstancing.is_enabled()) {
+      std::vector<const CSGProducts *> products;
+      for (const auto& p : {this->root_products_, this->background_products_, this->highlight_products_}) {
+        if (p) products.push_back(p.get());
+      }
+      surface_prototypes_ = createSurfacePrototypes(products, instance_vbos_, instance_states_);
+    }
+
     size_t num_vertices = 0;
-    if (this->root_products_) num_vertices += (getSurfaceBufferSize(this->root_products_, true) * 2);
-    if (this->background_products_) num_vertices += getSurfaceBufferSize(this->background_products_, true);
-    if (this->highlight_products_) num_vertices += getSurfaceBufferSize(this->highlight_products_, true);
+    if (this->root_products_) num_vertices += (getSurfaceBufferSize(this->root_products_, true, &surface_prototypes_) * 2);
+    if (this->background_products_) num_vertices += getSurfaceBufferSize(this->background_products_, true, &surface_prototypes_);
+    if (this->highlight_products_) num_vertices += getSurfaceBufferSize(this->highlight_products_, true, &surface_prototypes_);
 
     vertex_array.allocateBuffers(num_vertices);
 
@@ -190,6 +201,16 @@ void ThrownTogetherRenderer::createChainObject(VertexArray& vertex_array,
 
   const auto& leaf_color = csgobj.leaf->color;
   const auto csgmode = RendererUtils::getCsgMode(highlight_mode, background_mode, type);
+  const auto *prototype = findPrototype(surface_prototypes_, *csgobj.leaf->polyset, csgobj.leaf->matrix);
+  // Draw the leaf from its shared prototype if it has one, otherwise write its
+  // transformed vertices to the buffer
+  const auto add_surface = [&](const Transform3d& m, const Color4f& color) {
+    if (prototype) {
+      create_surface_instance(vertex_array, *prototype, m, color);
+    } else {
+      create_surface(*csgobj.leaf->polyset, vertex_array, csgmode, m, color);
+    }
+  };
 
   vertex_array.writeSurface();
 
@@ -198,9 +219,9 @@ void ThrownTogetherRenderer::createChainObject(VertexArray& vertex_array,
     const ColorMode colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, false, type);
     getShaderColor(colormode, leaf_color, color);
 
-    add_color(vertex_array, color);
+    add_color(vertex_array, color, prototype);
 
-    create_surface(*csgobj.leaf->polyset, vertex_array, csgmode, csgobj.leaf->matrix, color);
+    add_surface(csgobj.leaf->matrix, color);
     if (const auto vs = std::dynamic_pointer_cast<TTRVertexState>(vertex_array.states().back())) {
       vs->setCsgObjectIndex(csgobj.leaf->index);
     }
@@ -208,7 +229,7 @@ void ThrownTogetherRenderer::createChainObject(VertexArray& vertex_array,
     ColorMode colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, false, type);
     getShaderColor(colormode, leaf_color, color);
 
-    add_color(vertex_array, color);
+    add_color(vertex_array, color, prototype);
 
     auto cull = std::make_shared<VertexState>();
     cull->glBegin().emplace_back([]() {
@@ -224,7 +245,7 @@ void ThrownTogetherRenderer::createChainObject(VertexArray& vertex_array,
       // Scale 2D negative objects 10% in the Z direction to avoid z fighting
       mat *= Eigen::Scaling(1.0, 1.0, 1.1);
     }
-    create_surface(*csgobj.leaf->polyset, vertex_array, csgmode, mat, color);
+    add_surface(mat, color);
     if (auto vs = std::dynamic_pointer_cast<TTRVertexState>(vertex_array.states().back())) {
       vs->setCsgObjectIndex(csgobj.leaf->index);
     }
@@ -234,7 +255,7 @@ void ThrownTogetherRenderer::createChainObject(VertexArray& vertex_array,
     colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, true, type);
     getShaderColor(colormode, leaf_color, color);
 
-    add_color(vertex_array, color);
+    add_color(vertex_array, color, prototype);
 
     cull = std::make_shared<VertexState>();
     cull->glBegin().emplace_back([]() {
@@ -243,7 +264,7 @@ void ThrownTogetherRenderer::createChainObject(VertexArray& vertex_array,
     });
     vertex_states_.emplace_back(std::move(cull));
 
-    create_surface(*csgobj.leaf->polyset, vertex_array, csgmode, csgobj.leaf->matrix, color);
+    add_surface(csgobj.leaf->matrix, color);
     if (auto vs = std::dynamic_pointer_cast<TTRVertexState>(vertex_array.states().back())) {
       vs->setCsgObjectIndex(csgobj.leaf->index);
     }
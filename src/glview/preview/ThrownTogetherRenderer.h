@@ -71,4 +71,8 @@ private:
   std::shared_ptr<CSGProducts> background_products_;
   GLuint vertices_vbo_{0};
   GLuint elements_vbo_{0};
+  // Shared surfaces that instanced leaves draw from
+  SurfacePrototypes surface_prototypes_;
+  std::vector<std::shared_ptr<VertexState>> instance_states_;
+  std::vector<GLuint> instance_vbos_;
 };
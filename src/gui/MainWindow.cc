@@ -69,7 +69,10 @@
 #include "core/RenderVariables.h"
 #include "openscad.h"
 #include "geometry/GeometryCache.h"
+#include "geometry/ConversionCache.h"
+#include "geometry/Operation2DCache.h"
 #include "core/SourceFileCache.h"
+#include "core/FreetypeRenderer.h"
 #include "gui/OpenSCADApp.h"
 #include "core/parsersettings.h"
 #include "glview/RenderSettings.h"
@@ -880,6 +883,10 @@ void MainWindow::loadDesignSettings()
   GeometryCache::instance()->setMaxSizeMB(polySetCacheSizeMB);
   auto cgalCacheSizeMB = Preferences::inst()->getValue("advanced/cgalCacheSizeMB").toUInt();
   CGALCache::instance()->setMaxSizeMB(cgalCacheSizeMB);
+  auto conversionCacheSizeMB = Preferences::inst()->getValue("advanced/conversionCacheSizeMB").toUInt();
+  ConversionCache::instance()->setMaxSizeMB(conversionCacheSizeMB);
+  auto operation2DCacheSizeMB = Preferences::inst()->getValue("advanced/operation2DCacheSizeMB").toUInt();
+  Operation2DCache::instance()->setMaxSizeMB(operation2DCacheSizeMB);
   auto backend3D = Preferences::inst()->getValue("advanced/renderBackend3D").toString().toStdString();
   RenderSettings::inst()->backend3D = renderBackend3DFromString(backend3D);
 }
@@ -2813,9 +2820,12 @@ void MainWindow::actionFlushCaches()
 {
   GeometryCache::instance()->clear();
   CGALCache::instance()->clear();
+  ConversionCache::instance()->clear();
+  Operation2DCache::instance()->clear();
   dxf_dim_cache.clear();
   dxf_cross_cache.clear();
   SourceFileCache::instance()->clear();
+  FreetypeRenderer::clear_cache();
 
   setCurrentOutput();
   LOG("Caches Flushed");
@@ -52,6 +52,8 @@
 #include <QListWidget>
 #include <QListWidgetItem>
 #include <boost/algorithm/string.hpp>
+#include "geometry/ConversionCache.h"
+#include "geometry/Operation2DCache.h"
 #include "geometry/GeometryCache.h"
 #include "gui/AutoUpdater.h"
 #include "Feature.h"
@@ -128,6 +130,8 @@ void Preferences::init() {
   this->defaultmap["advanced/polysetCacheSizeMB"] = getValue("advanced/polysetCacheSize").toULongLong() / (1024ul * 1024ul); // carry over old settings if they exist
   this->defaultmap["advanced/cgalCacheSize"] = qulonglong(CGALCache::instance()->maxSizeMB()) * 1024ul * 1024ul;
   this->defaultmap["advanced/cgalCacheSizeMB"] = getValue("advanced/cgalCacheSize").toULongLong() / (1024ul * 1024ul); // carry over old settings if they exist
+  this->defaultmap["advanced/conversionCacheSizeMB"] = qulonglong(ConversionCache::instance()->maxSizeMB());
+  this->defaultmap["advanced/operation2DCacheSizeMB"] = qulonglong(Operation2DCache::instance()->maxSizeMB());
   this->defaultmap["advanced/openCSGLimit"] = RenderSettings::inst()->openCSGTermLimit;
   this->defaultmap["advanced/forceGoldfeather"] = false;
   this->defaultmap["advanced/undockableWindows"] = false;
@@ -193,6 +197,8 @@ void Preferences::init() {
   this->cgalCacheSizeMBEdit->setValidator(memvalidator);
 #endif
   this->polysetCacheSizeMBEdit->setValidator(memvalidator);
+  this->conversionCacheSizeMBEdit->setValidator(memvalidator);
+  this->operation2DCacheSizeMBEdit->setValidator(memvalidator);
   this->opencsgLimitEdit->setValidator(uintValidator);
   this->timeThresholdOnRenderCompleteSoundEdit->setValidator(uintValidator);
   this->consoleMaxLinesEdit->setValidator(uintValidator);
@@ -523,6 +529,20 @@ void Preferences::on_polysetCacheSizeMBEdit_textChanged(const QString& text)
   GeometryCache::instance()->setMaxSizeMB(text.toULong());
 }
 
+void Preferences::on_conversionCacheSizeMBEdit_textChanged(const QString& text)
+{
+  QSettingsCached settings;
+  settings.setValue("advanced/conversionCacheSizeMB", text);
+  ConversionCache::instance()->setMaxSizeMB(text.toULong());
+}
+
+void Preferences::on_operation2DCacheSizeMBEdit_textChanged(const QString& text)
+{
+  QSettingsCached settings;
+  settings.setValue("advanced/operation2DCacheSizeMB", text);
+  Operation2DCache::instance()->setMaxSizeMB(text.toULong());
+}
+
 void Preferences::on_opencsgLimitEdit_textChanged(const QString& text)
 {
   QSettingsCached settings;
@@ -1217,6 +1237,8 @@ void Preferences::updateGUI()
   BlockSignals<QCheckBox *>(this->openCSGWarningBox)->setChecked(getValue("advanced/opencsg_show_warning").toBool());
   BlockSignals<QLineEdit *>(this->cgalCacheSizeMBEdit)->setText(getValue("advanced/cgalCacheSizeMB").toString());
   BlockSignals<QLineEdit *>(this->polysetCacheSizeMBEdit)->setText(getValue("advanced/polysetCacheSizeMB").toString());
+  BlockSignals<QLineEdit *>(this->conversionCacheSizeMBEdit)->setText(getValue("advanced/conversionCacheSizeMB").toString());
+  BlockSignals<QLineEdit *>(this->operation2DCacheSizeMBEdit)->setText(getValue("advanced/operation2DCacheSizeMB").toString());
   BlockSignals<QLineEdit *>(this->opencsgLimitEdit)->setText(getValue("advanced/openCSGLimit").toString());
   BlockSignals<QCheckBox *>(this->localizationCheckBox)->setChecked(getValue("advanced/localization").toBool());
   BlockSignals<QCheckBox *>(this->autoReloadRaiseCheckBox)->setChecked(getValue("advanced/autoReloadRaise").toBool());
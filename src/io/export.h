@@ -254,6 +254,10 @@ std::string get_current_iso8601_date_time_utc();
 std::unique_ptr<OffscreenView> prepare_preview(Tree& tree, const ViewOptions& options, Camera& camera);
 bool export_png(const std::shared_ptr<const class Geometry>& root_geom, const ViewOptions& options, Camera& camera, std::ostream& output);
 bool export_png(const OffscreenView& glview, std::ostream& output);
+// Render one image per camera, from a single rendering context, and return
+// them as png files. Returns an empty vector on failure.
+std::vector<std::string> export_png_views(const std::shared_ptr<const class Geometry>& root_geom, const ViewOptions& options, std::vector<Camera>& cameras);
+std::vector<std::string> export_png_views(OffscreenView& glview, std::vector<Camera>& cameras);
 bool export_param(SourceFile *root, const fs::path& path, std::ostream& output);
 
 std::unique_ptr<PolySet> createSortedPolySet(const PolySet& ps);
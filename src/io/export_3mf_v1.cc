@@ -39,6 +39,7 @@
 #include "ColorUtil.h"
 #include "geometry/GeometryUtils.h"
 #include "geometry/PolySet.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/PolySetUtils.h"
 #include "utils/printutils.h"
 
@@ -335,6 +336,8 @@ static bool append_3mf(const std::shared_ptr<const Geometry>& geom, ExportContex
 #endif
   } else if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     return append_polyset(PolySetUtils::tessellate_faces(*ps), ctx);
+  } else if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return append_3mf(InstancedGeometry::resolve(instance), ctx);
   } else if (std::dynamic_pointer_cast<const Polygon2d>(geom)) { // NOLINT(bugprone-branch-clone)
     assert(false && "Unsupported file format");
   } else { // NOLINT(bugprone-branch-clone)
@@ -29,6 +29,7 @@
 #include "geometry/GeometryUtils.h"
 #include "io/export.h"
 #include "geometry/PolySet.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/PolySetUtils.h"
 #include "linalg.h"
 #include "core/ColorUtil.h"
@@ -268,6 +269,8 @@ bool append_3mf(const std::shared_ptr<const Geometry>& geom, ExportContext& ctx)
 #endif
   } else if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     return append_polyset(PolySetUtils::tessellate_faces(*ps), ctx);
+  } else if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    return append_3mf(InstancedGeometry::resolve(instance), ctx);
   } else if (std::dynamic_pointer_cast<const Polygon2d>(geom)) {
     assert(false && "Unsupported file format");
   } else {
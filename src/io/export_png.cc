@@ -2,14 +2,18 @@
 #include "utils/printutils.h"
 #include "glview/OffscreenView.h"
 #include "glview/CsgInfo.h"
+#include <algorithm>
 #include <ostream>
+#include <cstdint>
 #include <cstdio>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "glview/RenderSettings.h"
-
-#ifndef NULLGL
-
-#include "glview/cgal/CGALRenderer.h"
+#include "glview/SoftwareView.h"
+#include "io/imageutils.h"
+#include "utils/parallel.h"
 
 namespace {
 
@@ -18,11 +22,75 @@ void setupCamera(Camera& cam, const BoundingBox& bbox)
   if (cam.viewall) cam.viewAll(bbox);
 }
 
+void setupView(SoftwareView& view, const ViewOptions& options)
+{
+  view.setColorScheme(RenderSettings::inst()->colorscheme);
+  view.setShowFaces(!options["wireframe"]);
+  view.setShowCrosshairs(options["crosshairs"]);
+  view.setShowAxes(options["axes"]);
+  view.setShowEdges(options["edges"]);
+}
+
+bool export_png_software(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options, Camera& camera, std::ostream& output)
+{
+  PRINTD("export_png_software geom");
+  SoftwareView view(camera.pixel_width, camera.pixel_height);
+  view.addGeometry(root_geom);
+  setupCamera(camera, view.getBoundingBox());
+
+  view.setCamera(camera);
+  setupView(view, options);
+  view.paint();
+  return view.save(output);
+}
+
+// Encodes the RGBA images (top row first), each sized like its camera.
+// The images are independent, so they are encoded in parallel.
+std::vector<std::string> encode_png_views(const std::vector<std::vector<uint8_t>>& images, const std::vector<Camera>& cameras)
+{
+  std::vector<std::string> pngs(images.size());
+  parallelizable_for(0, images.size(), [&](size_t i) {
+    if (images[i].empty()) return;
+    std::ostringstream output;
+    if (write_png(output, const_cast<uint8_t *>(images[i].data()), cameras[i].pixel_width, cameras[i].pixel_height)) {
+      pngs[i] = output.str();
+    }
+  });
+  if (std::any_of(pngs.begin(), pngs.end(), [](const std::string& png) { return png.empty(); })) return {};
+  return pngs;
+}
+
+std::vector<std::string> export_png_views_software(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options, std::vector<Camera>& cameras)
+{
+  PRINTD("export_png_views_software geom");
+  SoftwareView view(0, 0);
+  view.addGeometry(root_geom);
+  setupView(view, options);
+  const BoundingBox bbox = view.getBoundingBox();
+
+  std::vector<std::vector<uint8_t>> images;
+  for (auto& camera : cameras) {
+    setupCamera(camera, bbox);
+    view.resize(camera.pixel_width, camera.pixel_height);
+    view.setCamera(camera);
+    view.paint();
+    images.push_back(view.getFramebuffer());
+  }
+  return encode_png_views(images, cameras);
+}
+
 }  // namespace
 
+#ifndef NULLGL
+
+#include "glview/cgal/CGALRenderer.h"
+
 bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options, Camera& camera, std::ostream& output)
 {
   PRINTD("export_png geom");
+  if (RenderSettings::inst()->backendImage == RenderBackendImage::CPUBackend) {
+    return export_png_software(root_geom, options, camera, output);
+  }
   std::unique_ptr<OffscreenView> glview;
   try {
     glview = std::make_unique<OffscreenView>(camera.pixel_width, camera.pixel_height);
@@ -108,10 +176,68 @@ bool export_png(const OffscreenView& glview, std::ostream& output)
   return true;
 }
 
+std::vector<std::string> export_png_views(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options, std::vector<Camera>& cameras)
+{
+  PRINTD("export_png_views geom");
+  if (RenderSettings::inst()->backendImage == RenderBackendImage::CPUBackend) {
+    return export_png_views_software(root_geom, options, cameras);
+  }
+
+  // One context, large enough for all views
+  unsigned int width = 0, height = 0;
+  for (const auto& camera : cameras) {
+    width = std::max(width, camera.pixel_width);
+    height = std::max(height, camera.pixel_height);
+  }
+  std::unique_ptr<OffscreenView> glview;
+  try {
+    glview = std::make_unique<OffscreenView>(width, height);
+  } catch (const OffscreenViewException &ex) {
+    fprintf(stderr, "Can't create OffscreenView: %s.\n", ex.what());
+    return {};
+  }
+  glview->setRenderer(std::make_shared<CGALRenderer>(root_geom));
+  glview->setColorScheme(RenderSettings::inst()->colorscheme);
+  glview->setShowFaces(!options["wireframe"]);
+  glview->setShowCrosshairs(options["crosshairs"]);
+  glview->setShowAxes(options["axes"]);
+  glview->setShowScaleProportional(options["scales"]);
+  glview->setShowEdges(options["edges"]);
+  return export_png_views(*glview, cameras);
+}
+
+std::vector<std::string> export_png_views(OffscreenView& glview, std::vector<Camera>& cameras)
+{
+  PRINTD("export_png_views");
+  const BoundingBox bbox = glview.getRenderer()->getBoundingBox();
+  std::vector<std::vector<uint8_t>> images;
+  for (auto& camera : cameras) {
+    if (camera.pixel_width > glview.ctx->width() || camera.pixel_height > glview.ctx->height()) {
+      LOG("Image size %1$dx%2$d exceeds the rendering context.", camera.pixel_width, camera.pixel_height);
+      return {};
+    }
+    setupCamera(camera, bbox);
+    // Render into the lower left corner of the shared context
+    glview.setCamera(camera);
+    glview.resizeGL(camera.pixel_width, camera.pixel_height);
+    glview.paintGL();
+    images.push_back(glview.getImage());
+  }
+  return encode_png_views(images, cameras);
+}
+
 #else // NULLGL
 
-bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options, Camera& camera, std::ostream& output) { return false; }
+bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options, Camera& camera, std::ostream& output)
+{
+  return export_png_software(root_geom, options, camera, output);
+}
 std::unique_ptr<OffscreenView> prepare_preview(Tree& tree, const ViewOptions& options, Camera& camera) { return nullptr; }
 bool export_png(const OffscreenView& glview, std::ostream& output) { return false; }
+std::vector<std::string> export_png_views(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options, std::vector<Camera>& cameras)
+{
+  return export_png_views_software(root_geom, options, cameras);
+}
+std::vector<std::string> export_png_views(OffscreenView& glview, std::vector<Camera>& cameras) { return {}; }
 
 #endif // NULLGL
@@ -26,6 +26,7 @@
 
 #include "io/export.h"
 #include "geometry/PolySet.h"
+#include "geometry/InstancedGeometry.h"
 #include "geometry/PolySetUtils.h"
 #include <algorithm>
 #include <cassert>
@@ -243,6 +244,9 @@ uint64_t append_stl(const std::shared_ptr<const Geometry>& geom, std::ostream& o
     }
   } else if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     triangle_count += append_stl(ps, output, binary);
+  } else if (const auto instance = std::dynamic_pointer_cast<const InstancedGeometry>(geom)) {
+    // Only one placed copy is alive at a time while writing
+    triangle_count += append_stl(InstancedGeometry::resolve(instance), output, binary);
 #ifdef ENABLE_CGAL
   } else if (const auto N = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
     triangle_count += append_stl(*N, output, binary);
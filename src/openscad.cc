@@ -26,9 +26,11 @@
 
 #include "openscad.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -228,6 +230,20 @@ bool with_output(const bool is_stdout, const std::string& filename, F f, std::io
   }
 }
 
+// Inserts a zero padded number before the extension, e.g. frame.png -> frame00042.png
+std::string numbered_filename(const std::string& filename, unsigned number)
+{
+  std::ostringstream oss;
+  oss << std::setw(5) << std::setfill('0') << number;
+
+  auto path = fs::path(filename);
+  auto extension = path.extension();
+  path.replace_extension();
+  path += oss.str();
+  path.replace_extension(extension);
+  return path.generic_string();
+}
+
 } // namespace
 
 void set_render_color_scheme(const std::string& color_scheme, const bool exit_if_not_found)
@@ -286,6 +302,7 @@ struct CommandLine
   const std::string& setName;
   const ViewOptions& viewOptions;
   const Camera& camera;
+  const std::vector<Camera>& cameras; // one per exported png view
   const boost::optional<FileFormat> export_format;
   const CmdLineExportOptions& exportOptions;
   const AnimateArgs animate;
@@ -321,14 +338,14 @@ AnimateArgs get_animate(const po::variables_map& vm) {
   return animate;
 }
 
-Camera get_camera(const po::variables_map& vm)
+Camera get_camera(const po::variables_map& vm, const std::string& camera_arg, const std::string& imgsize_arg)
 {
   Camera camera;
 
-  if (vm.count("camera")) {
+  if (!camera_arg.empty()) {
     std::vector<std::string> strs;
     std::vector<double> cam_parameters;
-    boost::split(strs, vm["camera"].as<std::string>(), boost::is_any_of(","));
+    boost::split(strs, camera_arg, boost::is_any_of(","));
     if (strs.size() == 6 || strs.size() == 7) {
       try {
         for (const auto& s : strs) {
@@ -369,9 +386,9 @@ Camera get_camera(const po::variables_map& vm)
 
   auto w = RenderSettings::inst()->img_width;
   auto h = RenderSettings::inst()->img_height;
-  if (vm.count("imgsize")) {
+  if (!imgsize_arg.empty()) {
     std::vector<std::string> strs;
-    boost::split(strs, vm["imgsize"].as<std::string>(), boost::is_any_of(","));
+    boost::split(strs, imgsize_arg, boost::is_any_of(","));
     if (strs.size() != 2) {
       LOG("Need 2 numbers for imgsize");
       exit(1);
@@ -390,6 +407,31 @@ Camera get_camera(const po::variables_map& vm)
   return camera;
 }
 
+/*!
+   Returns one camera per exported view. --camera and --imgsize may each be
+   given either once, applying to all views, or once per view.
+ */
+std::vector<Camera> get_cameras(const po::variables_map& vm)
+{
+  const auto camera_args = vm.count("camera") ? vm["camera"].as<std::vector<std::string>>() : std::vector<std::string>{};
+  const auto imgsize_args = vm.count("imgsize") ? vm["imgsize"].as<std::vector<std::string>>() : std::vector<std::string>{};
+  const size_t views = std::max<size_t>({1, camera_args.size(), imgsize_args.size()});
+  if ((camera_args.size() > 1 && camera_args.size() != views) ||
+      (imgsize_args.size() > 1 && imgsize_args.size() != views)) {
+    LOG("--camera and --imgsize need to be given either once or once per view");
+    exit(1);
+  }
+
+  std::vector<Camera> cameras;
+  for (size_t i = 0; i < views; ++i) {
+    const auto arg = [i](const std::vector<std::string>& args) {
+      return args.empty() ? std::string() : args[std::min(i, args.size() - 1)];
+    };
+    cameras.push_back(get_camera(vm, arg(camera_args), arg(imgsize_args)));
+  }
+  return cameras;
+}
+
 int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat export_format, SourceFile *root_file)
 {
   auto filename_str = fs::path(cmd.output_file).generic_string();
@@ -423,8 +465,12 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
 #endif
 
   Camera camera = cmd.camera;
+  std::vector<Camera> cameras = cmd.cameras;
   if (file_context) {
     camera.updateView(file_context, true);
+    for (auto& view_camera : cameras) {
+      view_camera.updateView(file_context, false);
+    }
   }
 
   // restore CWD after module instantiation finished
@@ -480,9 +526,24 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
     GeometryEvaluator geomevaluator(tree);
     std::unique_ptr<OffscreenView> glview;
     std::shared_ptr<const Geometry> root_geom;
-    if ((export_format == FileFormat::ECHO || export_format == FileFormat::PNG) && (cmd.viewOptions.renderer == RenderType::OPENCSG || cmd.viewOptions.renderer == RenderType::THROWNTOGETHER)) {
+    const bool preview = cmd.viewOptions.renderer == RenderType::OPENCSG || cmd.viewOptions.renderer == RenderType::THROWNTOGETHER;
+    if (export_format == FileFormat::PNG && preview && RenderSettings::inst()->backendImage == RenderBackendImage::CPUBackend) {
+      LOG("The CPU image rendering backend can't render previews, rendering the full geometry instead.");
+    }
+    if ((export_format == FileFormat::ECHO || export_format == FileFormat::PNG) && preview &&
+        RenderSettings::inst()->backendImage != RenderBackendImage::CPUBackend) {
       // OpenCSG or throwntogether png -> just render a preview
-      glview = prepare_preview(tree, cmd.viewOptions, camera);
+      if (export_format == FileFormat::PNG && cameras.size() > 1) {
+        // All views share one context, large enough for each of them
+        Camera context_camera = camera;
+        for (const auto& view_camera : cameras) {
+          context_camera.pixel_width = std::max(context_camera.pixel_width, view_camera.pixel_width);
+          context_camera.pixel_height = std::max(context_camera.pixel_height, view_camera.pixel_height);
+        }
+        glview = prepare_preview(tree, cmd.viewOptions, context_camera);
+      } else {
+        glview = prepare_preview(tree, cmd.viewOptions, camera);
+      }
       if (!glview) return 1;
     } else {
       // Force creation of concrete geometry (mostly for testing)
@@ -514,10 +575,27 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
       return 1;
     }
 
-    if (export_format == FileFormat::PNG) {
+    if (export_format == FileFormat::PNG && cameras.size() > 1) {
+      const auto pngs = glview ? export_png_views(*glview, cameras)
+                               : export_png_views(root_geom, cmd.viewOptions, cameras);
+      if (pngs.empty()) {
+        return 1;
+      }
+      for (size_t i = 0; i < pngs.size(); ++i) {
+        const auto& png = pngs[i];
+        bool success = true;
+        bool wrote = with_output(false, numbered_filename(filename_str, i), [&success, &png](std::ostream& stream) {
+          stream.write(png.data(), png.size());
+          success = stream.good();
+        }, std::ios::out | std::ios::binary);
+        if (!success || !wrote) {
+          return 1;
+        }
+      }
+    } else if (export_format == FileFormat::PNG) {
       bool success = true;
       bool wrote = with_output(cmd.is_stdout, filename_str, [&success, &root_geom, &cmd, &camera, &glview](std::ostream& stream) {
-        if (cmd.viewOptions.renderer == RenderType::BACKEND_SPECIFIC || cmd.viewOptions.renderer == RenderType::GEOMETRY) {
+        if (!glview) {
           success = export_png(root_geom, cmd.viewOptions, camera, stream);
         } else {
           success = export_png(*glview, stream);
@@ -648,15 +726,7 @@ int cmdline(const CommandLine& cmd)
     for (unsigned frame = start_frame; frame < limit_frame; ++frame) {
       render_variables.time = frame * (1.0 / cmd.animate.frames);
 
-      std::ostringstream oss;
-      oss << std::setw(5) << std::setfill('0') << frame;
-
-      auto frame_file = fs::path(cmd.output_file);
-      auto extension = frame_file.extension();
-      frame_file.replace_extension();
-      frame_file += oss.str();
-      frame_file.replace_extension(extension);
-      std::string frame_str = frame_file.generic_string();
+      std::string frame_str = numbered_filename(cmd.output_file, frame);
 
       LOG("Exporting %1$s...", cmd.filename);
 
@@ -806,11 +876,12 @@ int main(int argc, char **argv)
     ("version,v", "print the version")
     ("info", "print information about the build process\n")
 
-    ("camera", po::value<std::string>(), "camera parameters when exporting png: =translate_x,y,z,rot_x,y,z,dist or =eye_x,y,z,center_x,y,z")
+    ("camera", po::value<std::vector<std::string>>(), "camera parameters when exporting png: =translate_x,y,z,rot_x,y,z,dist or =eye_x,y,z,center_x,y,z. Give it multiple times to export one numbered png per camera from a single evaluation")
     ("autocenter", "adjust camera to look at object's center")
     ("viewall", "adjust camera to fit object")
     ("backend", po::value<std::string>(), "3D rendering backend to use: 'CGAL' (old/slow) [default] or 'Manifold' (new/fast)")
-    ("imgsize", po::value<std::string>(), "=width,height of exported png")
+    ("imgsize", po::value<std::vector<std::string>>(), "=width,height of exported png, once or once per camera")
+    ("render-backend", po::value<std::string>(), "=opengl|cpu -how to render exported png: using an OpenGL context [default] or the built-in software rasterizer")
     ("render", po::value<std::string>()->implicit_value(""), "for full geometry evaluation when exporting png")
     ("preview", po::value<std::string>()->implicit_value(""), "[=throwntogether] -for ThrownTogether preview png")
     ("animate", po::value<unsigned>(), "export N animated frames")
@@ -909,6 +980,10 @@ int main(int argc, char **argv)
     RenderSettings::inst()->backend3D = renderBackend3DFromString(vm["backend"].as<std::string>());
   }
 
+  if (vm.count("render-backend")) {
+    RenderSettings::inst()->backendImage = renderBackendImageFromString(vm["render-backend"].as<std::string>());
+  }
+
   if (vm.count("preview")) {
     if (vm["preview"].as<std::string>() == "throwntogether") viewOptions.renderer = RenderType::THROWNTOGETHER;
   } else if (vm.count("render")) {
@@ -1011,7 +1086,16 @@ int main(int argc, char **argv)
   }
 
   AnimateArgs animate = get_animate(vm);
-  Camera camera = get_camera(vm);
+  const std::vector<Camera> cameras = get_cameras(vm);
+
+  if (cameras.size() > 1) {
+    for (const auto& filename : output_files) {
+      if (filename == "-") {
+        LOG("Exporting multiple views is not supported when exporting to stdout.");
+        return 1;
+      }
+    }
+  }
 
   if (animate.frames) {
     for (const auto& filename : output_files) {
@@ -1056,7 +1140,8 @@ int main(int argc, char **argv)
             parameterFile,
             parameterSet,
             viewOptions,
-            camera,
+            cameras.front(),
+            cameras,
             export_format,
             export_options,
             animate,
@@ -1,6 +1,7 @@
 #pragma once
 #include <algorithm>
 #include <cstddef>
+#include <cstdlib>
 #include <vector>
 
 #if ENABLE_TBB
@@ -59,3 +60,18 @@ void parallelizable_cross_product_transform(const Container1 &cont1,
     }
   }
 }
+
+template <class Operation>
+void parallelizable_for(size_t begin, size_t end, const Operation &op) {
+#if ENABLE_TBB
+  if (!getenv("OPENSCAD_NO_PARALLEL")) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(begin, end), [&](const auto &range) {
+      for (size_t i = range.begin(); i != range.end(); i++)
+        op(i);
+    });
+    return;
+  }
+#endif
+  for (size_t i = begin; i < end; i++)
+    op(i);
+}
@@ -0,0 +1,61 @@
+#!/usr/bin/env python
+
+# Multiple view test
+#
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> --view=<n> [<openscad args>] file.png
+#
+#
+# step 1. Run OpenSCAD on the .scad file with several --camera arguments, exporting
+#         one numbered .png file per camera from a single evaluation
+# step 2. Copy the image of the given view to file.png
+# step 3. (done in CTest) - compare the generated .png file to expected output
+#         of a single view test with the same camera. they should be the same!
+#
+# This script should return 0 on success, not-0 on error.
+
+
+import sys, os, shutil, subprocess, argparse
+
+def failquit(*args):
+    if len(args)!=0: print(args, file=sys.stderr)
+    print('multiview_pngtest args:',str(sys.argv), file=sys.stderr)
+    print('exiting multiview_pngtest.py with failure', file=sys.stderr)
+    sys.exit(1)
+
+#
+# Parse arguments
+#
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+parser.add_argument('--view', required=True, type=int, help='Index of the view to compare')
+args, remaining_args = parser.parse_known_args()
+
+inputfile = remaining_args[0]
+pngfile = remaining_args[-1]
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("can't find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("can't find openscad executable named: " + args.openscad)
+
+outputdir = os.path.dirname(pngfile)
+inputbasename = os.path.splitext(os.path.split(inputfile)[1])[0]
+
+# Views are written to <name>00000.png, <name>00001.png, ...
+exportfile = os.path.join(outputdir, inputbasename + '-view.png')
+viewfile = os.path.join(outputdir, inputbasename + '-view' + '%05d' % args.view + '.png')
+
+fontdir = os.path.abspath(os.path.join(os.path.dirname(__file__), "data/ttf"))
+fontenv = os.environ.copy();
+fontenv["OPENSCAD_FONT_PATH"] = fontdir;
+export_cmd = [args.openscad, inputfile, '-o', exportfile] + remaining_args
+print('Running OpenSCAD:', ' '.join(export_cmd), file=sys.stderr)
+result = subprocess.call(export_cmd, env = fontenv)
+if result != 0:
+    failquit('OpenSCAD failed with return code ' + str(result))
+
+if not os.path.exists(viewfile):
+    failquit("OpenSCAD didn't write view " + str(args.view) + ' to ' + viewfile)
+shutil.copyfile(viewfile, pngfile)